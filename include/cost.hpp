@@ -0,0 +1,263 @@
+// Copyright 2023 watson.wang
+
+#include <algorithm>
+#include <cfloat>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include "lattice.hpp"
+
+#ifndef COST_HPP_
+#define COST_HPP_
+
+using namespace std;
+
+namespace fr {
+namespace cost {
+   /// @brief what is known about a candidate before it is sampled
+   struct Boundary
+   {
+      const Parameters& para;
+      const Status& sts;
+      const QuinticPolynomial& lat;
+      const Polynomial& lon;
+      double T;         // duration
+      double t_last;    // time of the last sample
+   };
+
+   enum class Axis
+   {
+      LATERAL,          // accumulated into Trajectory::cd
+      LONGITUDINAL      // accumulated into Trajectory::cv
+   };
+
+   /// A cost term is a small functor with
+   ///    static constexpr Axis axis;
+   ///    double operator()(const Boundary& b, const FrenetLane& samples) const;
+   /// and optionally
+   ///    double lowerBound(const Boundary& b) const;
+   /// which must never exceed operator() for the same candidate. Terms without it bound at 0.
+
+   inline double squareSum(const vector<double>& n)
+   {
+      double ans = 0.0;
+      for (size_t i = 0; i < n.size(); ++i) {
+         ans += n[i] * n[i];
+      }
+      return ans;
+   }
+
+   /// @brief sum of squared lateral jerk over the samples
+   struct LateralJerk
+   {
+      static constexpr Axis axis = Axis::LATERAL;
+      double weight;
+
+      double operator()(const Boundary&, const FrenetLane& samples) const { return weight * squareSum(samples.d_ddd); }
+      // the first and last samples are part of the sum
+      double lowerBound(const Boundary& b) const
+      {
+         double j0 = b.lat.jerk(0.0);
+         double jT = b.t_last > 0.0 ? b.lat.jerk(b.t_last) : 0.0;
+         return weight * (j0 * j0 + jT * jT);
+      }
+   };
+
+   /// @brief sum of squared longitudinal jerk over the samples
+   struct LongitudinalJerk
+   {
+      static constexpr Axis axis = Axis::LONGITUDINAL;
+      double weight;
+
+      double operator()(const Boundary&, const FrenetLane& samples) const { return weight * squareSum(samples.s_ddd); }
+      double lowerBound(const Boundary& b) const
+      {
+         double j0 = b.lon.jerk(0.0);
+         double jT = b.t_last > 0.0 ? b.lon.jerk(b.t_last) : 0.0;
+         return weight * (j0 * j0 + jT * jT);
+      }
+   };
+
+   /// @brief duration of the candidate
+   template <Axis A>
+   struct Time
+   {
+      static constexpr Axis axis = A;
+      double weight;
+
+      double operator()(const Boundary& b, const FrenetLane&) const { return weight * b.T; }
+      double lowerBound(const Boundary& b) const { return weight * b.T; }
+   };
+
+   /// @brief squared lateral offset at the last sample
+   struct LateralOffset
+   {
+      static constexpr Axis axis = Axis::LATERAL;
+      double weight;
+
+      double operator()(const Boundary&, const FrenetLane& samples) const { return weight * samples.d.back() * samples.d.back(); }
+      double lowerBound(const Boundary& b) const
+      {
+         double d = b.lat.position(b.t_last);
+         return weight * d * d;
+      }
+   };
+
+   /// @brief squared deviation from the target speed at the last sample
+   struct SpeedError
+   {
+      static constexpr Axis axis = Axis::LONGITUDINAL;
+      double weight;
+
+      double operator()(const Boundary& b, const FrenetLane& samples) const
+      {
+         double e = b.para.target_speed - samples.s_d.back();
+         return weight * e * e;
+      }
+      double lowerBound(const Boundary& b) const
+      {
+         double e = b.para.target_speed - b.lon.velocity(b.t_last);
+         return weight * e * e;
+      }
+   };
+
+   /// @brief sum of squared lateral acceleration over the samples, no cheap bound
+   struct LateralAcceleration
+   {
+      static constexpr Axis axis = Axis::LATERAL;
+      double weight;
+
+      double operator()(const Boundary&, const FrenetLane& samples) const { return weight * squareSum(samples.d_dd); }
+   };
+
+   template <class Term, class = void>
+   struct has_lower_bound : false_type {};
+
+   template <class Term>
+   struct has_lower_bound<Term, void_t<decltype(declval<const Term&>().lowerBound(declval<const Boundary&>()))>> : true_type {};
+
+   /// @brief sum of cost terms composed at compile time.
+   /// cf = K_LAT * (lateral terms) + K_LON * (longitudinal terms), as in the original formula.
+   template <class... Terms>
+   class CostModel
+   {
+   public:
+      explicit CostModel(Terms... terms) : _terms(terms...) {}
+
+      /// @brief fill cd, cv and cf of a sampled candidate
+      void evaluate(const Boundary& b, Trajectory& tj) const
+      {
+         double cd = 0.0;
+         double cv = 0.0;
+         std::apply([&](const Terms&... term) {
+            (((Terms::axis == Axis::LATERAL ? cd : cv) += term(b, tj.samples)), ...);
+         }, _terms);
+
+         tj.cd = cd;
+         tj.cv = cv;
+         tj.cf = b.para.K_LAT * cd + b.para.K_LON * cv;
+      }
+
+      /// @brief lower bound of cf from the boundary conditions only
+      double lowerBound(const Boundary& b) const
+      {
+         double cd = 0.0;
+         double cv = 0.0;
+         std::apply([&](const Terms&... term) {
+            (((Terms::axis == Axis::LATERAL ? cd : cv) += bound(term, b)), ...);
+         }, _terms);
+
+         return b.para.K_LAT * cd + b.para.K_LON * cv;
+      }
+
+   private:
+      std::tuple<Terms...> _terms;
+
+      template <class Term>
+      static double bound(const Term& term, const Boundary& b)
+      {
+         if constexpr (has_lower_bound<Term>::value) {
+            return term.lowerBound(b);
+         }
+         else {
+            return 0.0;
+         }
+      }
+   };
+
+   template <class... Terms>
+   CostModel<Terms...> makeCost(Terms... terms)
+   {
+      return CostModel<Terms...>(terms...);
+   }
+
+   /// @brief the planner's original cost
+   inline auto makeDefaultCost(const Parameters& para)
+   {
+      return makeCost(
+         LateralJerk{ para.K_J }, Time<Axis::LATERAL>{ para.K_T }, LateralOffset{ para.K_D },
+         LongitudinalJerk{ para.K_J }, Time<Axis::LONGITUDINAL>{ para.K_T }, SpeedError{ para.K_D });
+   }
+}
+
+   template <class Cost>
+   Trajectory FrenetPath::generatePath(const Cost& cost)
+   {
+      _start = std::chrono::steady_clock::now();
+      // the snapshot's own index unless it is stale, the snapshot itself is never written
+      _index = _obj->indexed() ? shared_ptr<const ob::ObstacleIndex>(_obj, &_obj->static_index)
+                               : make_shared<const ob::ObstacleIndex>(_obj->static_obstacles);
+      // collision structures only ever describe the current cycle
+      _field.reset();
+      _occupancy.reset();
+      _motion.reset();
+      if (_para.collision_mode == CollisionMode::FRENET && _table) buildOccupancy();
+      else if (_para.collision_mode != CollisionMode::POINT) buildDistanceField();
+      if (!_obj->moving_obstacles.empty()) buildMotionSlices();
+      vector<Candidate> candidates = generateCandidates();
+      Trajectory path = findOptimal(cost, candidates);
+      if (!path.ok && _emergency) {
+         path = emergencyPath();
+      }
+      return path;
+   }
+
+   /// Best first: candidates are visited by increasing lower bound, and the search stops as soon
+   /// as no remaining candidate can beat the best feasible one, or at plan_deadline. Lower bounds are only admissible
+   /// if every K weight is non negative.
+   template <class Cost>
+   Trajectory FrenetPath::findOptimal(const Cost& cost, vector<Candidate>& candidates)
+   {
+      for (auto& c : candidates) {
+         c.bound = cost.lowerBound({ _para, _sts, *c.tj.lateral_polynomial, c.tj.longitudinal(), c.ti, c.t_last });
+      }
+      stable_sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+         return a.bound < b.bound;
+         });
+
+      Trajectory path;
+      double min_cf = DBL_MAX;
+      for (auto& c : candidates) {
+         if (c.bound >= min_cf || deadlineExpired()) break;
+
+         if (c.tj.samples.t.empty()) {
+            sampleTrajectory(c.tj, c.ti);
+         }
+         cost.evaluate({ _para, _sts, *c.tj.lateral_polynomial, c.tj.longitudinal(), c.ti, c.t_last }, c.tj);
+         if (c.tj.cf >= min_cf) continue;
+         if (!checkKinematics(c.tj)) continue;
+
+         checkPath(c.tj);
+         if (c.tj.ok) {
+            min_cf = c.tj.cf;
+            path = std::move(c.tj);
+         }
+      }
+
+      // checked in Frenet space, only the chosen one is converted
+      if (path.ok && path.global.x.empty()) calcGlobalPath(path);
+      return path;
+   }
+}
+
+#endif
@@ -0,0 +1,56 @@
+// Copyright 2023 watson.wang
+
+#include <vector>
+#include "obstacle.hpp"
+
+#ifndef DISTANCE_FIELD_HPP_
+#define DISTANCE_FIELD_HPP_
+
+using namespace std;
+
+namespace ob {
+   /// @brief Euclidean distance transform of the static obstacles over an axis aligned grid.
+   /// A cell is occupied if its square intersects an obstacle, and every cell stores the distance
+   /// from its center to the nearest occupied cell center. A point is looked up at the center of
+   /// its cell, so with resolution h the stored value overestimates the true clearance by at most
+   /// h / sqrt(2) (point to center) + h / sqrt(2) (obstacle to occupied center); distance() removes
+   /// ERROR_FACTOR * h = sqrt(2) h and never reports more clearance than there is, but may report
+   /// up to 2 sqrt(2) h less.
+   class DistanceField
+   {
+   public:
+      static constexpr double ERROR_FACTOR = 1.41421356237309504880;
+
+      DistanceField() = default;
+      /// @brief rasterize the obstacles inside area and transform, area is rounded up to whole cells
+      explicit DistanceField(const vector<stationaryObj>& obstacles, const geo_box& area, double resolution);
+      virtual ~DistanceField() = default;
+
+      DistanceField(const DistanceField&) = default;
+      DistanceField(DistanceField&&) noexcept = default;
+
+      DistanceField& operator = (const DistanceField&) = default;
+      DistanceField& operator = (DistanceField&&) noexcept = default;
+
+      double resolution() const { return _h; }
+      double maxError() const { return ERROR_FACTOR * _h; }
+
+      /// @brief true if the disk of radius r around (x, y) lies inside the grid, obstacles outside
+      /// the grid are not rasterized and distance() does not see them
+      bool contains(double x, double y, double r = 0.0) const;
+      /// @brief lower bound of the distance from (x, y) to the nearest rasterized obstacle, 0 inside
+      /// one, requires contains(x, y)
+      double distance(double x, double y) const;
+
+   private:
+      double _x0{};
+      double _y0{};
+      double _h{};
+      size_t _cols{};
+      size_t _rows{};
+
+      vector<float> _dist{};
+   };
+}
+
+#endif
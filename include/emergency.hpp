@@ -0,0 +1,58 @@
+// Copyright 2023 watson.wang
+
+#include <vector>
+#include "lattice.hpp"
+
+#ifndef EMERGENCY_HPP_
+#define EMERGENCY_HPP_
+
+using namespace std;
+
+namespace fr {
+   /// @brief longitudinal stop profile sampled at time_tick over max_pred_time, s relative to the start
+   struct BrakeProfile
+   {
+      double decel{};
+      double stop_time{};
+      vector<double> s{};
+      vector<double> s_d{};
+      vector<double> s_dd{};
+      vector<double> s_ddd{};
+   };
+
+   /// @brief braking profiles precomputed once per Parameters, indexed by quantized speed and
+   /// acceleration. Every entry holds one profile per deceleration level, ordered from the
+   /// mildest to max_deceleration; a profile brakes to standstill and then holds.
+   class EmergencyLibrary
+   {
+   public:
+      explicit EmergencyLibrary(const Parameters& para, double speed_step = 0.5, double acc_step = 0.5);
+      virtual ~EmergencyLibrary() = default;
+
+      EmergencyLibrary(const EmergencyLibrary&) = default;
+      EmergencyLibrary& operator = (const EmergencyLibrary&) = default;
+
+      EmergencyLibrary(EmergencyLibrary&&) noexcept = default;
+      EmergencyLibrary& operator = (EmergencyLibrary&&) noexcept = default;
+
+      /// @brief profiles for the speed rounded up and the acceleration rounded to the grid
+      const vector<BrakeProfile>& lookup(double v, double a) const;
+      /// @brief bp resampled from the exact speed v and acceleration a, so a fallback starts where
+      /// the ego is. The stop time is stretched again for (v, a), which also covers speeds above
+      /// max_speed that lookup clamps to the last grid row
+      BrakeProfile startingAt(const BrakeProfile& bp, double v, double a) const;
+
+   private:
+      double _speed_step{};
+      double _acc_step{};
+      double _min_acc{};
+      double _time_tick{};
+      double _horizon{};
+      size_t _num_v{};
+      size_t _num_a{};
+
+      vector<vector<BrakeProfile>> _profiles{};
+   };
+}
+
+#endif
@@ -0,0 +1,58 @@
+// Copyright 2023 watson.wang
+
+#include <memory>
+#include <vector>
+#include "lane/reference_table.hpp"
+#include "obstacle.hpp"
+
+#ifndef FRENET_OCCUPANCY_HPP_
+#define FRENET_OCCUPANCY_HPP_
+
+using namespace std;
+
+namespace fr {
+   /// @brief static obstacles as blocked d-intervals per s-bin along the reference line, so
+   /// Frenet samples can be checked without converting them to Cartesian.
+   /// Obstacle outlines are projected once, densified to half a bin, and every bin keeps the d
+   /// span of the outline within it, so a concave outline blocks its whole span. Spans are grown
+   /// by radius in d and by floor(radius / ds) + 1 bins in s, then sorted and merged per bin. On a
+   /// curve a disk at offset d spans radius / (1 - kappa d) along s, which the extra bin covers
+   /// while kappa d radius stays below ds.
+   class FrenetOccupancy
+   {
+   public:
+      struct Interval
+      {
+         double lo;
+         double hi;
+      };
+
+      FrenetOccupancy() = default;
+      /// @brief project the obstacles over [s_begin, s_end) in bins of ds
+      explicit FrenetOccupancy(const vector<ob::stationaryObj>& obstacles, shared_ptr<const es::ReferenceTable> table,
+         double s_begin, double s_end, double ds, double radius);
+      virtual ~FrenetOccupancy() = default;
+
+      FrenetOccupancy(const FrenetOccupancy&) = default;
+      FrenetOccupancy(FrenetOccupancy&&) noexcept = default;
+
+      FrenetOccupancy& operator = (const FrenetOccupancy&) = default;
+      FrenetOccupancy& operator = (FrenetOccupancy&&) noexcept = default;
+
+      /// @brief true if (s, d) lies in a blocked interval, s outside the bins counts as blocked
+      bool isBlocked(double s, double d) const;
+      /// @brief true if any sample is blocked
+      bool collides(const vector<double>& s, const vector<double>& d) const;
+
+   private:
+      double _s0{};
+      double _ds{};
+      size_t _bins{};
+
+      // bin b holds _intervals[_offsets[b] .. _offsets[b + 1]), sorted and disjoint
+      vector<size_t> _offsets{};
+      vector<Interval> _intervals{};
+   };
+}
+
+#endif
@@ -6,6 +6,7 @@
 using geo_point = boost::geometry::model::point<
 	double, 2, boost::geometry::cs::cartesian>;
 using geo_ring = boost::geometry::model::ring<geo_point>;
+using geo_box = boost::geometry::model::box<geo_point>;
 
 using boost::geometry::dsv;
 
@@ -1,10 +1,15 @@
 // Copyright 2023 watson.wang
 
+#include <chrono>
 #include <vector>
 #include <optional>
 #include "lane/euler_spiral.hpp"
+#include "lane/spiral_evaluator.hpp"
+#include "lane/reference_table.hpp"
 #include "polynomials.hpp"
 #include "obstacle.hpp"
+#include "distance_field.hpp"
+#include "frenet_occupancy.hpp"
 
 #ifndef LATTICE_HPP_
 #define LATTICE_HPP_
@@ -12,6 +17,20 @@
 using namespace std;
 
 namespace fr {
+   enum class LongitudinalMode
+   {
+      SPEED_SAMPLING,   // sample target speeds around target_speed
+      ST_GRAPH          // dynamic programming over the s-t occupancy of moving obstacles
+   };
+
+   enum class CollisionMode
+   {
+      POINT,            // trajectory points in obstacle polygons, exact
+      RADIUS,           // a disk of radius around every point, on the distance field
+      FOOTPRINT,        // footprint_circles disks covering vehicle_length x vehicle_width, on the distance field
+      FRENET            // a disk of radius around every Frenet sample on FrenetOccupancy, needs a reference table
+   };
+
    struct Parameters
    {
       double max_speed;
@@ -36,6 +55,24 @@ namespace fr {
       double start_x;
       double start_y;
       double start_yaw;
+
+      LongitudinalMode lon_mode{ LongitudinalMode::SPEED_SAMPLING };
+      double st_s_resolution{ 0.25 };
+      double st_t_resolution{ 0.5 };
+
+      double max_deceleration{ 6.0 };
+      double plan_deadline{ 0.0 };      // seconds, 0 disables
+
+      size_t spiral_resync_interval{ 8 };  // incremental reference steps between exact evaluations, 0 evaluates every sample
+      es::FresnelPrecision fresnel_precision{ es::FresnelPrecision::DOUBLE };  // Fresnel tier of the reference line
+
+      CollisionMode collision_mode{ CollisionMode::POINT };
+      double distance_field_resolution{ 0.25 };  // meters per cell, clearance is underestimated by up to 2 sqrt(2) cells
+      double distance_field_extent{ 40.0 };      // half width of the grid, centered half of it ahead of the ego
+      double vehicle_length{ 4.8 };
+      double vehicle_width{ 1.9 };
+      size_t footprint_circles{ 3 };
+      double frenet_s_resolution{ 0.5 };         // s-bin length of the Frenet occupancy
    };
 
    struct FrenetLane
@@ -89,6 +126,14 @@ namespace fr {
 
       std::optional<QuinticPolynomial> lateral_polynomial{};
       std::optional<QuarticPolynomial> longitudinal_polynomial{};
+      std::optional<QuinticPolynomial> longitudinal_quintic_polynomial{};
+
+      /// @brief the longitudinal polynomial in use, quintic if set, quartic otherwise
+      const Polynomial& longitudinal() const
+      {
+         if (longitudinal_quintic_polynomial) return *longitudinal_quintic_polynomial;
+         return *longitudinal_polynomial;
+      }
       
       FrenetLane samples{};
       CartesianLane global{};
@@ -98,13 +143,19 @@ namespace fr {
       double cf{};
 
       bool ok{};
+      bool emergency{};
    };
 
+   class StGraph;
+   class EmergencyLibrary;
+
    class FrenetPath
    {
    public:
-      explicit FrenetPath(Parameters para, es::SpiralParameter rfl, Status sts, shared_ptr<ob::Constraints> obj) :
-          _para(para), _rfl(rfl), _sts(sts), _obj{std::move(obj)} {}
+      /// @param obj obstacle snapshot, read only; its static_index is used if it matches, otherwise
+      /// every cycle builds its own
+      explicit FrenetPath(Parameters para, es::SpiralParameter rfl, Status sts, shared_ptr<const ob::Constraints> obj) :
+          _para(para), _rfl(rfl), _ref(rfl, para.start_x, para.start_y, para.start_yaw, para.fresnel_precision), _sts(sts), _obj{std::move(obj)} {}
       virtual ~FrenetPath() = default;
 
       FrenetPath(const FrenetPath&) = default;
@@ -114,20 +165,56 @@ namespace fr {
       FrenetPath& operator = (FrenetPath&&) noexcept = default;
 
       Trajectory generatePath();
+      /// @brief plan with a compile time composed cost model, defined in cost.hpp
+      template <class Cost> Trajectory generatePath(const Cost& cost);
       void setStatus(Status sts);
+      /// @brief fallback used when no candidate is feasible before plan_deadline
+      void setEmergencyLibrary(shared_ptr<const EmergencyLibrary> lib);
+      /// @brief reference line table built once and shared, replaces spiral evaluation when set
+      void setReferenceTable(shared_ptr<const es::ReferenceTable> table);
 
    private:
+      /// @brief a candidate before it is sampled
+      struct Candidate
+      {
+         Trajectory tj;
+         double ti;        // duration
+         double t_last;    // time of the last sample
+         double bound;     // lower bound of the cost
+      };
+
       Parameters _para{};
       es::SpiralParameter _rfl{};
+      es::PreparedSpiral _ref;
       Status _sts{};
-      std::shared_ptr<ob::Constraints> _obj{};
-
-      vector<Trajectory> generateTrajectories();
-      void calcGlobalPaths(vector<Trajectory>& trajs);
+      std::shared_ptr<const ob::Constraints> _obj{};
+      std::shared_ptr<const ob::ObstacleIndex> _index{};   // over _obj->static_obstacles for this cycle
+      std::shared_ptr<const EmergencyLibrary> _emergency{};
+      std::shared_ptr<const es::ReferenceTable> _table{};
+      std::chrono::steady_clock::time_point _start{};
+      std::optional<ob::DistanceField> _field{};
+      std::optional<FrenetOccupancy> _occupancy{};
+      std::shared_ptr<const ob::MotionSlices> _motion{};
+
+      bool deadlineExpired() const;
+      vector<Candidate> generateCandidates();
+      void sampleTrajectory(Trajectory& tj, double ti);
+      bool planSpeedProfile(Trajectory& tj, double ti, StGraph& graph);
+      void calcCurvature(Trajectory& tj);
+      bool checkKinematics(Trajectory& tj);
+      void calcGlobalPath(Trajectory& tj);
       bool isCollision(Trajectory &trajs);
-
-      void checkPaths(vector<Trajectory>& trajs);
-      Trajectory findOptimal(vector<Trajectory>& trajs);
+      void buildDistanceField();
+      void buildOccupancy();
+      void buildMotionSlices();
+      bool isMovingCollision(const Trajectory& traj);
+      double footprint(vector<double>& offsets) const;
+
+      void checkPath(Trajectory& tj);
+      bool overlapsObstacles(const Trajectory& tj);
+      static geo_box trajectoryBox(const Trajectory& tj);
+      Trajectory emergencyPath();
+      template <class Cost> Trajectory findOptimal(const Cost& cost, vector<Candidate>& candidates);
    };
 }
 
@@ -0,0 +1,69 @@
+// Copyright 2023 watson.wang
+
+#include <atomic>
+#include <cstdint>
+
+#ifndef MAILBOX_HPP_
+#define MAILBOX_HPP_
+
+namespace fr {
+   /// @brief single producer single consumer handoff that only keeps the newest value.
+   /// Three slots: the producer owns one, the consumer owns one and the third is swapped
+   /// atomically between them, so both sides are wait free and a value is never queued
+   /// behind an older one.
+   template <class T>
+   class Mailbox
+   {
+   public:
+      Mailbox() = default;
+      virtual ~Mailbox() = default;
+
+      Mailbox(const Mailbox&) = delete;
+      Mailbox& operator = (const Mailbox&) = delete;
+
+      /// @brief producer: slot to fill before publish()
+      T& back() { return _slots[_back]; }
+
+      /// @brief producer: hand the filled slot over, replacing any unread value
+      void publish()
+      {
+         _back = _middle.exchange(static_cast<uint8_t>(_back | FRESH), std::memory_order_acq_rel) & INDEX;
+      }
+
+      /// @brief producer: copy and publish
+      void post(const T& value)
+      {
+         back() = value;
+         publish();
+      }
+
+      /// @brief true if a value was published since the consumer's last fetch()
+      [[nodiscard]] bool fresh() const
+      {
+         return _middle.load(std::memory_order_acquire) & FRESH;
+      }
+
+      /// @brief consumer: take the newest value if there is one
+      /// @return false if nothing was published since the last call
+      bool fetch()
+      {
+         if (!fresh()) return false;
+         _front = _middle.exchange(_front, std::memory_order_acq_rel) & INDEX;
+         return true;
+      }
+
+      /// @brief consumer: last fetched value, untouched by the producer until the next fetch()
+      const T& front() const { return _slots[_front]; }
+
+   private:
+      static constexpr uint8_t INDEX = 0x3;
+      static constexpr uint8_t FRESH = 0x4;
+
+      T _slots[3]{};
+      uint8_t _front{ 0 };
+      uint8_t _back{ 1 };
+      std::atomic<uint8_t> _middle{ 2 };
+   };
+}
+
+#endif
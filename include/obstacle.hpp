@@ -1,6 +1,8 @@
 // Copyright 2023 watson.wang
 
+#include <utility>
 #include <vector>
+#include <boost/geometry/index/rtree.hpp>
 #include "geomtry.hpp"
 
 #ifndef OBSTACLE_HPP_
@@ -12,7 +14,7 @@ namespace ob {
 
     class obstacle {
     public:
-        explicit obstacle(geo_ring poly) :_poly(poly){}
+        explicit obstacle(geo_ring poly) :_poly(poly), _box(boost::geometry::return_envelope<geo_box>(_poly)) {}
         virtual ~obstacle() = default;
       
         obstacle(const obstacle&) = default;
@@ -21,10 +23,13 @@ namespace ob {
         obstacle & operator = (const obstacle&) = default;
         obstacle & operator = (obstacle&&) noexcept = default;
 
-        geo_ring getPoly(){ return _poly; };
+        const geo_ring& getPoly() const { return _poly; };
+        // axis aligned bounds of the footprint, computed once with the obstacle
+        const geo_box& getBox() const { return _box; };
 
     protected:
         geo_ring _poly{};
+        geo_box _box{};
     };
 
 
@@ -41,10 +46,26 @@ namespace ob {
         stationaryObj& operator = (stationaryObj&&) noexcept = default;
     };
 
+   /// @brief displacement of a moving obstacle from its snapshot footprint t seconds later, the
+   /// footprint turns by yaw about its centroid and then moves by (x, y)
+   struct PredictedPose
+   {
+      double t{};
+      double x{};
+      double y{};
+      double yaw{};
+   };
+
    class movingObj : public obstacle {
 
    public:
-      explicit movingObj(geo_ring poly) :obstacle(poly) {}
+      explicit movingObj(geo_ring poly) :obstacle(poly), _center(boost::geometry::return_centroid<geo_point>(_poly)) {}
+      /// @brief constant turn rate and velocity: (vx, vy) and the footprint turn together at yaw_rate
+      explicit movingObj(geo_ring poly, double vx, double vy, double yaw_rate = 0.0) :obstacle(poly),
+         _vx(vx), _vy(vy), _yaw_rate(yaw_rate), _center(boost::geometry::return_centroid<geo_point>(_poly)) {}
+      /// @brief sampled prediction, poses by increasing t, linear in between and held outside
+      explicit movingObj(geo_ring poly, vector<PredictedPose> path) :obstacle(poly),
+         _path(std::move(path)), _center(boost::geometry::return_centroid<geo_point>(_poly)) {}
       virtual ~movingObj() = default;
 
       movingObj(const movingObj&) = default;
@@ -52,14 +73,112 @@ namespace ob {
 
       movingObj& operator = (const movingObj&) = default;
       movingObj& operator = (movingObj&&) noexcept = default;
+
+      // displacement t seconds after the snapshot, from the sampled path if there is one
+      PredictedPose pose(double t) const;
+      // footprint t seconds after the snapshot
+      geo_ring predict(double t) const;
+
+   protected:
+      double _vx{};
+      double _vy{};
+      double _yaw_rate{};
+      vector<PredictedPose> _path{};
+      geo_point _center{};
    };
 
 
 
+   /// @brief R-tree over the boxes of a set of static obstacles, bulk loaded once per obstacle
+   /// snapshot. Entries refer to the obstacles by index, so queries take the vector the index
+   /// was built from, or one that matches() it.
+   class ObstacleIndex
+   {
+   public:
+      /// @brief polyline points per query box in collides()
+      static constexpr size_t SEGMENT = 8;
+
+      ObstacleIndex() = default;
+      explicit ObstacleIndex(const vector<stationaryObj>& obstacles);
+      virtual ~ObstacleIndex() = default;
+
+      ObstacleIndex(const ObstacleIndex&) = default;
+      ObstacleIndex(ObstacleIndex&&) noexcept = default;
+
+      ObstacleIndex& operator = (const ObstacleIndex&) = default;
+      ObstacleIndex& operator = (ObstacleIndex&&) noexcept = default;
+
+      size_t size() const { return _tree.size(); }
+      /// @brief true if obstacles has the boxes the index was built from, in the same order. The
+      /// exact tests read the polygons from obstacles, so the index stays valid for them
+      bool matches(const vector<stationaryObj>& obstacles) const;
+
+      /// @brief true if an obstacle box intersects box
+      bool intersects(const geo_box& box) const;
+      /// @brief true if a point of the polyline lies inside an obstacle. The polyline is queried
+      /// in pieces of SEGMENT points, so the cost follows the obstacles near it
+      bool collides(const vector<stationaryObj>& obstacles, const vector<double>& x, const vector<double>& y) const;
+      /// @brief true if an obstacle comes closer than r to (x, y), exact polygon distance
+      bool near(const vector<stationaryObj>& obstacles, double x, double y, double r) const;
+
+   private:
+      using Entry = pair<geo_box, size_t>;
+      boost::geometry::index::rtree<Entry, boost::geometry::index::quadratic<16>> _tree{};
+      vector<geo_box> _boxes{};    // by obstacle
+   };
+
+   /// @brief moving obstacles predicted once per cycle on the planner's time grid.
+   /// Slice k holds every footprint at k tick and the box it sweeps over [(k - 1/2) tick,
+   /// (k + 1/2) tick]: the union of SWEEP_STEPS + 1 predicted boxes across the window, grown by
+   /// half the largest vertex step between them so turning footprints stay inside. A sample is
+   /// only checked against the slice of its time.
+   class MotionSlices
+   {
+   public:
+      static constexpr int SWEEP_STEPS = 4;
+
+      MotionSlices() = default;
+      explicit MotionSlices(const vector<movingObj>& movers, double tick, size_t slices);
+      virtual ~MotionSlices() = default;
+
+      MotionSlices(const MotionSlices&) = default;
+      MotionSlices(MotionSlices&&) noexcept = default;
+
+      MotionSlices& operator = (const MotionSlices&) = default;
+      MotionSlices& operator = (MotionSlices&&) noexcept = default;
+
+      size_t size() const { return _slices; }
+      size_t movers() const { return _movers; }
+      /// @brief t is inside the window of a slice
+      bool covers(double t) const { return t >= -0.5 * _tick && t < (_slices - 0.5) * _tick; }
+      /// @brief slice whose window holds t, clamped to the first and last
+      size_t sliceOf(double t) const;
+      const geo_box& sweptBox(size_t slice, size_t mover) const { return _swept[slice * _movers + mover]; }
+
+      /// @brief true if a swept box of any slice intersects box
+      bool intersects(const geo_box& box) const;
+      /// @brief true if a footprint of the slice of t comes closer than r to (x, y), r = 0 tests
+      /// the point against the footprints
+      bool collides(double t, double x, double y, double r) const;
+
+   private:
+      double _tick{};
+      size_t _slices{};
+      size_t _movers{};
+
+      vector<geo_ring> _footprints{};   // slice major
+      vector<geo_box> _swept{};         // slice major
+      vector<geo_box> _bounds{};        // union of the swept boxes per slice
+   };
+
    struct Constraints
    {
       vector<stationaryObj> static_obstacles;
       vector<movingObj> moving_obstacles;
+      ObstacleIndex static_index{};    // over static_obstacles, built by the owner before the snapshot is shared
+
+      void buildIndex() { static_index = ObstacleIndex(static_obstacles); }
+      bool indexed() const { return static_index.matches(static_obstacles); }
    };
 }
 
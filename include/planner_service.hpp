@@ -0,0 +1,75 @@
+// Copyright 2023 watson.wang
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "lattice.hpp"
+#include "mailbox.hpp"
+
+#ifndef PLANNER_SERVICE_HPP_
+#define PLANNER_SERVICE_HPP_
+
+using namespace std;
+
+namespace fr {
+   struct PlanResult
+   {
+      Trajectory traj{};
+      Status input{};       // status the trajectory was planned from
+      uint64_t cycle{};     // 0 until the first plan is published
+   };
+
+   /// @brief runs FrenetPath on a dedicated thread.
+   /// The control thread posts the newest Status and obstacle snapshot and reads the newest
+   /// PlanResult; none of these calls block or wait for planning. Inputs posted while a cycle
+   /// is running replace each other, so the next cycle always starts from the newest ones.
+   class PlannerService
+   {
+   public:
+      explicit PlannerService(Parameters para, es::SpiralParameter rfl);
+      virtual ~PlannerService();
+
+      PlannerService(const PlannerService&) = delete;
+      PlannerService& operator = (const PlannerService&) = delete;
+
+      /// @brief before start(): fallback used when no lattice candidate is feasible
+      void setEmergencyLibrary(shared_ptr<const EmergencyLibrary> emergency);
+      /// @brief before start(): tabulated reference line, shared by every cycle
+      void setReferenceTable(shared_ptr<const es::ReferenceTable> table);
+
+      void start();
+      void stop();
+
+      /// @brief control thread: newest ego status, triggers a planning cycle
+      void postStatus(const Status& sts);
+      /// @brief control thread: newest obstacle snapshot, kept until replaced. Indexed here on the
+      /// control thread if needed, the snapshot must not change once posted
+      void postObstacles(shared_ptr<ob::Constraints> obj);
+      /// @brief control thread: newest published plan, valid until the next call
+      const PlanResult& latest();
+
+   private:
+      Parameters _para{};
+      es::SpiralParameter _rfl{};
+      shared_ptr<const EmergencyLibrary> _emergency{};
+      shared_ptr<const es::ReferenceTable> _table{};
+
+      Mailbox<Status> _status{};
+      Mailbox<shared_ptr<const ob::Constraints>> _obstacles{};
+      Mailbox<PlanResult> _result{};
+
+      // only used to wake the planning thread, never held by the control thread
+      mutex _wake_mtx{};
+      condition_variable _wake{};
+
+      atomic<bool> _running{ false };
+      thread _worker{};
+
+      void run();
+   };
+}
+
+#endif
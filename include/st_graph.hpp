@@ -0,0 +1,65 @@
+// Copyright 2023 watson.wang
+
+#include <vector>
+#include "lattice.hpp"
+
+#ifndef ST_GRAPH_HPP_
+#define ST_GRAPH_HPP_
+
+using namespace std;
+
+namespace fr {
+   /// @brief s-t occupancy grid of predicted moving obstacles along one lateral profile,
+   /// searched by dynamic programming for the cheapest speed profile.
+   /// Rows are spaced by about st_t_resolution up to the lateral duration, columns are s cells of
+   /// st_s_resolution starting at the ego s. Every node only looks back max_speed * dt / ds cells,
+   /// so projection and search are linear in the grid size.
+   class StGraph
+   {
+   public:
+      /// @brief sample the reference line once per cycle
+      /// @param slices swept boxes of the movers, if set rows skip the movers whose box misses the ego corridor
+      /// @param table reference line of the candidates if set, rfl is only evaluated without one
+      explicit StGraph(const Parameters& para, const es::SpiralParameter& rfl, const Status& sts,
+         const vector<ob::movingObj>& movers, shared_ptr<const ob::MotionSlices> slices = nullptr,
+         shared_ptr<const es::ReferenceTable> table = nullptr);
+      virtual ~StGraph() = default;
+
+      StGraph(const StGraph&) = default;
+      StGraph& operator = (const StGraph&) = default;
+
+      StGraph(StGraph&&) noexcept = default;
+      StGraph& operator = (StGraph&&) noexcept = default;
+
+      /// @brief project the predicted movers onto the grid for the ego following lat over [0, T]
+      /// @return true if any cell is occupied
+      bool project(const QuinticPolynomial& lat, double T);
+      /// @brief dynamic programming over the projected grid
+      /// @param t time of every grid row
+      /// @param s s of the cheapest collision free profile at every grid row
+      /// @return false if no collision free profile exists
+      bool search(vector<double>& t, vector<double>& s) const;
+      /// @brief true if a grid cell around (t, s) is occupied
+      [[nodiscard]] bool isOccupied(double t, double s) const;
+
+   private:
+      Parameters _para{};
+      Status _sts{};
+      vector<ob::movingObj> _movers{};
+      shared_ptr<const ob::MotionSlices> _slices{};
+
+      double _ds{};
+      double _dt{};
+      size_t _num_s{};
+      size_t _rows{};
+
+      vector<double> _ref_x{};
+      vector<double> _ref_y{};
+      vector<double> _ref_nx{};
+      vector<double> _ref_ny{};
+
+      vector<char> _occupied{};
+   };
+}
+
+#endif
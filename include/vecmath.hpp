@@ -0,0 +1,31 @@
+// Copyright 2023 watson.wang
+
+#include <cstddef>
+
+#ifndef VECMATH_HPP_
+#define VECMATH_HPP_
+
+namespace fr {
+   /// @brief batch transcendental kernels over contiguous arrays.
+   /// With AVX2 and FMA four lanes run per instruction, otherwise the same polynomials run
+   /// one element at a time, so both paths share the error bounds below. Outputs may alias
+   /// the inputs element for element. Errors are measured against long double over the
+   /// stated ranges, NaN and infinite inputs are not supported.
+   namespace vecmath {
+      /// @brief |x| above this takes std::sin / std::cos, the reduction by pi/2 stays exact below it
+      constexpr double SINCOS_MAX_ARG = 1.0e6;
+
+      /// @brief s[i] = sin(x[i]), c[i] = cos(x[i]): Cody-Waite reduction to [-pi/4, pi/4] and
+      /// the cephes minimax polynomials, within 2 ulp
+      void sincos(const double* x, size_t n, double* s, double* c);
+
+      /// @brief out[i] = atan2(y[i], x[i]): reduction to [0, 1] and the cephes rational atan,
+      /// within 2 ulp. atan2(0, 0) is 0, atan2(+-0, x < 0) is +-pi
+      void atan2(const double* y, const double* x, size_t n, double* out);
+
+      /// @brief out[i] = sqrt(x[i]^2 + y[i]^2) without rescaling, within 1.5 ulp for |x|, |y| < 1e150
+      void hypot(const double* x, const double* y, size_t n, double* out);
+   }
+}
+
+#endif
@@ -6,18 +6,180 @@
 #include <corecrt_math_defines.h>
 #include <cfloat>
 #include <algorithm>
+#include <array>
 #include "euler_spiral.hpp"
 #include "fresnel_integral.hpp"
 
 namespace es
 {
-  
+
+namespace {
+
+// longest piece of getSeriesOffset in radians of k h when the downward recurrence is
+// needed, it amplifies rounding by about exp(beta) / beta
+constexpr double SERIES_MAX_BETA = 2.0;
+constexpr int SERIES_MAX_ORDER = 12;
+constexpr double SERIES_EPS = 1.0e-17;
+constexpr int SERIES_MAX_MOMENTS = 3;
+
+// number of eps terms, |eps|^(n+1) / (n+1)! is the first one left out
+int seriesOrder(double eps) {
+
+  int n = 0;
+  for (double t = std::abs(eps); n < SERIES_MAX_ORDER && t > SERIES_EPS; t *= std::abs(eps) / (n + 2)) {
+    ++n;
+  }
+  return n;
+}
+
+// moments int_0^h t^j exp(i (k t + dk t^2 / 2)) dt for j < count, (er, ei) = exp(i k h).
+// With u = t / h, beta = k h and eps = dk h^2 / 2 moment j is
+//   h^(j+1) * sum_n (i eps)^n / n! * J_2n+j,   J_m = int_0^1 u^m exp(i beta u) du,
+// J_m = (exp(i beta) - m J_m-1) / (i beta). The recurrence is stable upwards for m <= |beta|,
+// so for |beta| >= the highest order it starts at J_0; otherwise |beta| <= SERIES_MAX_BETA,
+// the highest J is seeded by its power series and the recurrence runs downwards.
+void seriesPiece(double h, double dk, double k, int count, double* x, double* y, double& er, double& ei) {
+
+  static constexpr int MAX_INV = 64;
+  static const auto INV = [] {
+    std::array<double, MAX_INV> inv{};
+    for (int i = 1; i < MAX_INV; ++i) inv[i] = 1.0 / i;
+    return inv;
+  }();
+
+  const double beta = k * h;
+  const double eps = 0.5 * dk * h * h;
+  const int n = seriesOrder(eps);
+  const int top = 2 * n + count - 1;
+
+  double jr[2 * SERIES_MAX_ORDER + SERIES_MAX_MOMENTS], ji[2 * SERIES_MAX_ORDER + SERIES_MAX_MOMENTS];
+
+  er = std::cos(beta);
+  ei = std::sin(beta);
+
+  if (std::abs(beta) >= std::max(top, 1)) {
+    // (a + ib) / (i beta) = (b - ia) / beta
+    const double ib = 1.0 / beta;
+    jr[0] = ei * ib;
+    ji[0] = (1.0 - er) * ib;
+    for (int m = 1; m <= top; ++m) {
+      jr[m] = (ei - m * ji[m - 1]) * ib;
+      ji[m] = (m * jr[m - 1] - er) * ib;
+    }
+  }
+  else {
+    // J_top = sum_j (i beta)^j / (j! (top + j + 1))
+    double tr = 1.0, ti = 0.0;
+    jr[top] = INV[top + 1];
+    ji[top] = 0.0;
+    for (int j = 1; j + top + 1 < MAX_INV && std::abs(tr) + std::abs(ti) > SERIES_EPS; ++j) {
+      double r = -ti * beta * INV[j];
+      ti = tr * beta * INV[j];
+      tr = r;
+      jr[top] += tr * INV[top + j + 1];
+      ji[top] += ti * INV[top + j + 1];
+    }
+
+    for (int m = top; m > 0; --m) {
+      jr[m - 1] = (er + beta * ji[m]) * INV[m];
+      ji[m - 1] = (ei - beta * jr[m]) * INV[m];
+    }
+  }
+
+  // sum_n (i eps)^n / n! J_2n+j
+  double hp = h;
+  for (int j = 0; j < count; ++j) {
+    double cr = 1.0, ci = 0.0;
+    double sr = jr[j], si = ji[j];
+    for (int i = 1; i <= n; ++i) {
+      double r = -ci * eps * INV[i];
+      ci = cr * eps * INV[i];
+      cr = r;
+      sr += cr * jr[2 * i + j] - ci * ji[2 * i + j];
+      si += cr * ji[2 * i + j] + ci * jr[2 * i + j];
+    }
+    x[j] = hp * sr;
+    y[j] = hp * si;
+    hp *= h;
+  }
+}
+
+// moments int_0^L s^j exp(i (initCurv s + dCurv s^2 / 2)) ds for j < count
+void getSeriesMoments(double length, double dCurv, double initCurv, int count, double* x, double* y) {
+
+  // one piece if the upward recurrence applies or beta is small, otherwise pieces with
+  // |beta| <= SERIES_MAX_BETA
+  int pieces = 1;
+  double kMax = std::max(std::abs(initCurv), std::abs(initCurv + dCurv * length));
+  double top = 2.0 * seriesOrder(0.5 * dCurv * length * length) + count - 1;
+  if (std::abs(initCurv * length) < std::max(top, 1.0) && kMax * std::abs(length) > SERIES_MAX_BETA) {
+    pieces = static_cast<int>(std::ceil(kMax * std::abs(length) / SERIES_MAX_BETA));
+  }
+  double h = length / pieces;
+
+  // the heading advances by k_i h + dk h^2 / 2 per piece, exp(i dk h^2 / 2) is shared
+  const double eps = 0.5 * dCurv * h * h;
+  const double qr = std::cos(eps), qi = std::sin(eps);
+
+  for (int j = 0; j < count; ++j) {
+    x[j] = 0.0;
+    y[j] = 0.0;
+  }
+  double c = 1.0, sn = 0.0;
+  for (int i = 0; i < pieces; ++i) {
+    double s0 = i * h;
+    double px[SERIES_MAX_MOMENTS], py[SERIES_MAX_MOMENTS], er, ei;
+    seriesPiece(h, dCurv, initCurv + dCurv * s0, count, px, py, er, ei);
+
+    // shift the piece moments by s0, (s0 + t)^j expanded binomially
+    double mx[SERIES_MAX_MOMENTS], my[SERIES_MAX_MOMENTS];
+    mx[0] = px[0];
+    my[0] = py[0];
+    if (count > 1) {
+      mx[1] = s0 * px[0] + px[1];
+      my[1] = s0 * py[0] + py[1];
+    }
+    if (count > 2) {
+      mx[2] = s0 * s0 * px[0] + 2.0 * s0 * px[1] + px[2];
+      my[2] = s0 * s0 * py[0] + 2.0 * s0 * py[1] + py[2];
+    }
+    for (int j = 0; j < count; ++j) {
+      x[j] += mx[j] * c - my[j] * sn;
+      y[j] += mx[j] * sn + my[j] * c;
+    }
+
+    if (i + 1 < pieces) {
+      double rr = er * qr - ei * qi, ri = er * qi + ei * qr;
+      double t = c * rr - sn * ri;
+      sn = c * ri + sn * rr;
+      c = t;
+    }
+  }
+}
+
+} // namespace
+
+void getSeriesOffset(double length, double dCurv, double initCurv, double& x, double& y) {
+
+  getSeriesMoments(length, dCurv, initCurv, 1, &x, &y);
+}
+
+bool useSeriesOffset(double length, double dCurv, double initCurv) {
+
+  if (std::abs(dCurv * length * length) > SERIES_LIMIT) return false;
+
+  // largest Fresnel argument |k| / sqrt(pi |dCurv|), compared squared
+  double k = std::max(std::abs(initCurv), std::abs(initCurv + dCurv * length));
+  return k * k > SERIES_MIN_ARG * SERIES_MIN_ARG * M_PI * std::abs(dCurv);
+}
+
 SpiralPoint getEndPointFromCurvature(double length, double curvStart, double curvEnd, double initX /*= 0.0*/, double initY /*= 0.0*/, double initTheta /*= 0.0*/) {
 
   return getEndPoint(length, (curvEnd - curvStart) / length, curvStart, initX, initY, initTheta);
 }
 
-SpiralPoint getEndPoint(double length, double dCurv, double initCurv /*= 1000.0*/, double initX /*= 0.0*/, double initY /*= 0.0*/, double initTheta /*= 0.0*/) {
+SpiralPoint getEndPoint(double length, double dCurv, double initCurv /*= 1000.0*/, double initX /*= 0.0*/, double initY /*= 0.0*/, double initTheta /*= 0.0*/,
+                        FresnelPrecision precision /*= FresnelPrecision::DOUBLE*/) {
 
   SpiralPoint pos;
 
@@ -34,11 +196,21 @@ SpiralPoint getEndPoint(double length, double dCurv, double initCurv /*= 1000.0*
     pos.x = x * cos(initTheta) - y * sin(initTheta);
     pos.y = x * sin(initTheta) + y * cos(initTheta);
   }
+  else if (useSeriesOffset(length, dCurv, initCurv)) {
+    // near line or near arc, the Fresnel arguments are huge and their difference cancels
+    double x, y;
+    getSeriesOffset(length, dCurv, initCurv, x, y);
+
+    pos.x = x * cos(initTheta) - y * sin(initTheta);
+    pos.y = x * sin(initTheta) + y * cos(initTheta);
+  }
   else {
     double a = 1.0 / sqrt(M_PI * abs(dCurv));
 
-    double x = fresnel_cos_integral((initCurv + dCurv * length) * a) - fresnel_cos_integral(initCurv * a);
-    double y = fresnel_sin_integral((initCurv + dCurv * length) * a) - fresnel_sin_integral(initCurv * a);
+    FresnelPair f1 = fresnel_cs((initCurv + dCurv * length) * a, precision);
+    FresnelPair f0 = fresnel_cs(initCurv * a, precision);
+    double x = f1.c - f0.c;
+    double y = f1.s - f0.s;
 
     double theta = initTheta - initCurv * initCurv * 0.5 / dCurv;
     if (dCurv < 0.0) x *= -1.0;
@@ -246,6 +418,155 @@ SpiralParameter solveIteratively(const SpiralPoint& start, const SpiralPoint& go
   return res;
 }
 
+namespace {
+
+// moments int_0^L s^j exp(i (initCurv s + dCurv s^2 / 2)) ds, j = 0..2. Away from the series
+// range the higher ones follow from the end point by parts:
+//   k M0 + dk M1 = -i (E - 1),   L E = M0 + i (k M1 + dk M2),   E = exp(i theta(L))
+void getSpiralMoments(double length, double dCurv, double initCurv, double* x, double* y) {
+
+  if (std::abs(dCurv * length * length) <= SERIES_LIMIT) {
+    getSeriesMoments(length, dCurv, initCurv, 3, x, y);
+    return;
+  }
+
+  SpiralPoint end = getEndPoint(length, dCurv, initCurv);
+  double er = cos(end.t), ei = sin(end.t);
+  x[0] = end.x;
+  y[0] = end.y;
+  x[1] = (ei - initCurv * x[0]) / dCurv;
+  y[1] = (1.0 - er - initCurv * y[0]) / dCurv;
+
+  double qx = length * er - x[0] + initCurv * y[1];
+  double qy = length * ei - y[0] - initCurv * x[1];
+  x[2] = qy / dCurv;
+  y[2] = -qx / dCurv;
+}
+
+struct FitEval {
+  double rx, ry;             // end point minus goal, start frame
+  double jk[2], jl[2];       // derivatives by initCurv and length
+  double norm;
+};
+
+// P(k, L) = M0 with dk = 2 (dTheta - k L) / L^2, so
+//   dP/dk = i M1 + i M2 / 2 * ddk/dk = i (M1 - M2 / L)
+//   dP/dL = exp(i dTheta) + i M2 / 2 * ddk/dL,   ddk/dL = (2 k L - 4 dTheta) / L^3
+FitEval evalFit(double k, double L, double dTheta, double gx, double gy) {
+
+  double dk = 2.0 * (dTheta - k * L) / L / L;
+  double mx[3], my[3];
+  getSpiralMoments(L, dk, k, mx, my);
+
+  FitEval e;
+  e.rx = mx[0] - gx;
+  e.ry = my[0] - gy;
+  e.norm = sqrt(e.rx * e.rx + e.ry * e.ry);
+
+  e.jk[0] = -(my[1] - my[2] / L);
+  e.jk[1] = mx[1] - mx[2] / L;
+
+  double ddk = (2.0 * k * L - 4.0 * dTheta) / L / L / L;
+  e.jl[0] = cos(dTheta) - 0.5 * my[2] * ddk;
+  e.jl[1] = sin(dTheta) + 0.5 * mx[2] * ddk;
+  return e;
+}
+
+// Levenberg-Marquardt from (k, L) for at most maxItrNum iterations, res holds the last iterate
+bool solveFit(double k, double L, double dTheta, double gx, double gy, double tol, size_t maxItrNum, FitResult& res) {
+
+  FitEval cur = evalFit(k, L, dTheta, gx, gy);
+  double lambda = 1.0e-3;
+
+  size_t itr = 0;
+  while (itr < maxItrNum && cur.norm > tol && lambda < 1.0e12) {
+    ++itr;
+
+    // (J^T J + lambda diag(J^T J)) delta = -J^T r
+    double a00 = cur.jk[0] * cur.jk[0] + cur.jk[1] * cur.jk[1];
+    double a01 = cur.jk[0] * cur.jl[0] + cur.jk[1] * cur.jl[1];
+    double a11 = cur.jl[0] * cur.jl[0] + cur.jl[1] * cur.jl[1];
+    double g0 = cur.jk[0] * cur.rx + cur.jk[1] * cur.ry;
+    double g1 = cur.jl[0] * cur.rx + cur.jl[1] * cur.ry;
+
+    double b00 = a00 * (1.0 + lambda), b11 = a11 * (1.0 + lambda);
+    double det = b00 * b11 - a01 * a01;
+    if (!(std::abs(det) > 0.0)) {
+      lambda *= 10.0;
+      continue;
+    }
+    double tk = k - (b11 * g0 - a01 * g1) / det;
+    double tl = L - (b00 * g1 - a01 * g0) / det;
+
+    if (tl > 0.0) {
+      FitEval trial = evalFit(tk, tl, dTheta, gx, gy);
+      if (trial.norm < cur.norm) {
+        k = tk;
+        L = tl;
+        cur = trial;
+        lambda = std::max(lambda * 0.1, 1.0e-12);
+        continue;
+      }
+    }
+    lambda *= 10.0;
+  }
+
+  res.param.initCurv = k;
+  res.param.length = L;
+  res.param.dCurv = 2.0 * (dTheta - k * L) / L / L;
+  res.iterations += itr;
+  res.residual = cur.norm;
+  res.converged = cur.norm <= tol;
+  return res.converged;
+}
+
+} // namespace
+
+FitResult fitSpiral(const SpiralPoint& start, const SpiralPoint& goal, const SpiralParameter* seed, size_t maxItrNum, double tolerance) {
+
+  FitResult res;
+  SpiralParameter est, p2;
+  if (seed) {
+    est = *seed;
+  }
+  else if (calcInitialEstimate(start, goal, est, p2) != ShapeType::BIARC) {
+    // a line or a single arc is exact already
+    est.dCurv = 0.0;
+    res.param = est;
+    SpiralPoint end = getEndPoint(est.length, 0.0, est.initCurv, start.x, start.y, start.t);
+    res.residual = sqrt((end.x - goal.x) * (end.x - goal.x) + (end.y - goal.y) * (end.y - goal.y));
+    res.converged = res.residual <= tolerance * std::max(1.0, est.length);
+    return res;
+  }
+
+  // goal in the start frame
+  const double dTheta = goal.t - start.t;
+  const double c0 = cos(start.t), s0 = sin(start.t);
+  const double gx = (goal.x - start.x) * c0 + (goal.y - start.y) * s0;
+  const double gy = -(goal.x - start.x) * s0 + (goal.y - start.y) * c0;
+  const double r = sqrt(gx * gx + gy * gy);
+  const double tol = tolerance * std::max(1.0, r);
+
+  if (solveFit(est.initCurv, est.length > 0.0 ? est.length : r, dTheta, gx, gy, tol, maxItrNum, res)) {
+    return res;
+  }
+
+  // The biarc may wind the wrong way round. Retry from the small angle approximation along the
+  // chord: theta(t) = phi0 + (dTheta - A) t + A t^2 on t in [0, 1] has int sin(theta - phi) = 0 for
+  // A = 3 (2 phi0 + dTheta), phi0 being the start heading against the chord.
+  double phi0 = -atan2(gy, gx);
+  double A = 3.0 * (2.0 * phi0 + dTheta);
+  SpiralPoint unit = getEndPoint(1.0, 2.0 * A, dTheta - A, 0.0, 0.0, phi0);
+  double L = unit.x > 0.0 ? r / unit.x : r;
+  FitResult retry;
+  retry.iterations = res.iterations;
+  if (solveFit((dTheta - A) / L, L, dTheta, gx, gy, tol, maxItrNum, retry) || retry.residual < res.residual) {
+    return retry;
+  }
+  res.iterations = retry.iterations;
+  return res;
+}
+
 SpiralParameter getParameter(const SpiralPoint& start, const SpiralPoint& goal, SpiralParameter* init, size_t maxItrNum) {
 
   SpiralParameter est, p2;
@@ -255,6 +576,12 @@ SpiralParameter getParameter(const SpiralPoint& start, const SpiralPoint& goal,
     *init = est;
   
   if (stype == ShapeType::BIARC) {
+    FitResult fit = fitSpiral(start, goal, &est);
+    if (fit.converged) {
+      return fit.param;
+    }
+
+    // the coordinate search is slower but does not need a good seed
     est = solveIteratively(start, goal, est, maxItrNum);
 
     est.dCurv = 2.0 * (goal.t - start.t - (est.initCurv * est.length)) / est.length / est.length;
@@ -1,5 +1,7 @@
 // modified from https://github.com/CoffeeKumazaki/euler_spiral
 
+#include "fresnel_integral.hpp"
+
 #ifndef EULER_HPP_
 #define EULER_HPP_
 
@@ -15,6 +17,13 @@ struct SpiralParameter {
   double dCurv     = 0.0;
 };
 
+struct FitResult {
+  SpiralParameter param;
+  size_t iterations = 0;
+  double residual   = 0.0;   // end point distance to the goal
+  bool converged    = false;
+};
+
 enum class ShapeType
 {
   LINE,
@@ -23,10 +32,24 @@ enum class ShapeType
   INVALID = -1
 };
 
-SpiralPoint getEndPoint(double length, double dCurv, double initCurv = 0.0, double initX = 0.0, double initY = 0.0, double initTheta = 0.0);
+// getSeriesOffset replaces the Fresnel integrals for |dCurv * length^2| <= SERIES_LIMIT once a
+// Fresnel argument exceeds SERIES_MIN_ARG; below it the Fresnel power series is cheap and exact.
+// Measured against a long double quadrature the series stays within 3e-16 * length up to 0.5,
+// where the Fresnel route loses up to 1e-7 * length on near straight spirals.
+constexpr double SERIES_LIMIT = 0.5;
+constexpr double SERIES_MIN_ARG = 0.5;
+
+SpiralPoint getEndPoint(double length, double dCurv, double initCurv = 0.0, double initX = 0.0, double initY = 0.0, double initTheta = 0.0,
+                        FresnelPrecision precision = FresnelPrecision::DOUBLE);
 SpiralPoint getEndPointFromCurvature(double length, double curvStart, double curvEnd, double initX = 0.0, double initY = 0.0, double initTheta = 0.0);
 SpiralParameter getParameter(const SpiralPoint& start, const SpiralPoint& goal, SpiralParameter* init = nullptr, size_t maxItrNum = 100000);
+// Levenberg-Marquardt on (initCurv, length), dCurv follows from the heading change. Seeded by
+// seed (e.g. the previous solution) or by calcBiarcSolution.
+FitResult fitSpiral(const SpiralPoint& start, const SpiralPoint& goal, const SpiralParameter* seed = nullptr, size_t maxItrNum = 50, double tolerance = 1.0e-9);
 ShapeType calcBiarcSolution(const SpiralPoint &start, const SpiralPoint &goal, SpiralParameter &p1, SpiralParameter &p2);
+// end point of a spiral starting at the origin with heading 0, by series expansion in dCurv
+void getSeriesOffset(double length, double dCurv, double initCurv, double& x, double& y);
+bool useSeriesOffset(double length, double dCurv, double initCurv);
 
 } // namespace es
 
@@ -0,0 +1,122 @@
+// Copyright 2023 watson.wang
+
+#include <cmath>
+#include <algorithm>
+#include "fit_cache.hpp"
+
+namespace es
+{
+
+FitCache::FitCache(size_t capacity, double positionStep, double angleStep, double tolerance)
+  : _capacity(capacity), _invPos(1.0 / positionStep), _invAngle(1.0 / angleStep), _tolerance(tolerance), _hits(0), _misses(0) {
+}
+
+size_t FitCache::KeyHash::operator () (const Key& k) const {
+
+  uint64_t h = static_cast<uint64_t>(k.x) * 0x9E3779B97F4A7C15ull;
+  h ^= static_cast<uint64_t>(k.y) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+  h ^= static_cast<uint64_t>(k.t) + 0x9E3779B97F4A7C15ull + (h << 6) + (h >> 2);
+  return static_cast<size_t>(h);
+}
+
+FitCache::Key FitCache::makeKey(const SpiralPoint& start, const SpiralPoint& goal) const {
+
+  // goal in the start frame, the heading change is kept unwrapped like in fitSpiral
+  double c = std::cos(start.t), s = std::sin(start.t);
+  double dx = goal.x - start.x, dy = goal.y - start.y;
+
+  Key key;
+  key.x = std::llround((dx * c + dy * s) * _invPos);
+  key.y = std::llround((-dx * s + dy * c) * _invPos);
+  key.t = std::llround((goal.t - start.t) * _invAngle);
+  return key;
+}
+
+bool FitCache::find(const Key& key, SpiralParameter& param) {
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  auto it = _index.find(key);
+  if (it == _index.end()) {
+    ++_misses;
+    return false;
+  }
+
+  ++_hits;
+  _lru.splice(_lru.begin(), _lru, it->second);
+  param = it->second->second;
+  return true;
+}
+
+void FitCache::insert(const Key& key, const SpiralParameter& param) {
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  auto it = _index.find(key);
+  if (it != _index.end()) {
+    // refitted for another pose in the cell, or fitted by another thread meanwhile: the newest
+    // fit seeds the next query best
+    it->second->second = param;
+    _lru.splice(_lru.begin(), _lru, it->second);
+    return;
+  }
+
+  _lru.emplace_front(key, param);
+  _index.emplace(key, _lru.begin());
+  while (_lru.size() > _capacity) {
+    _index.erase(_lru.back().first);
+    _lru.pop_back();
+  }
+}
+
+FitResult FitCache::fit(const SpiralPoint& start, const SpiralPoint& goal) {
+
+  const Key key = makeKey(start, goal);
+  SpiralParameter cached;
+  if (find(key, cached)) {
+    FitResult res;
+    res.param = cached;
+    SpiralPoint end = getEndPoint(cached.length, cached.dCurv, cached.initCurv, start.x, start.y, start.t);
+    res.residual = std::sqrt((end.x - goal.x) * (end.x - goal.x) + (end.y - goal.y) * (end.y - goal.y));
+    res.converged = res.residual <= _tolerance * std::max(1.0, cached.length);
+    if (res.converged) return res;
+
+    // same cell, different pose: the cached spiral is a close seed
+    FitResult refit = fitSpiral(start, goal, &cached, 50, _tolerance);
+    if (refit.converged) {
+      if (_capacity > 0) insert(key, refit.param);
+      return refit;
+    }
+  }
+
+  FitResult res = fitSpiral(start, goal, nullptr, 50, _tolerance);
+  if (res.converged && _capacity > 0) {
+    insert(key, res.param);
+  }
+  return res;
+}
+
+SpiralParameter FitCache::getParameter(const SpiralPoint& start, const SpiralPoint& goal) {
+
+  FitResult res = fit(start, goal);
+  return res.converged ? res.param : es::getParameter(start, goal);
+}
+
+FitCacheStats FitCache::stats() const {
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  FitCacheStats st;
+  st.hits = _hits;
+  st.misses = _misses;
+  st.size = _lru.size();
+  return st;
+}
+
+void FitCache::clear() {
+
+  std::lock_guard<std::mutex> lock(_mtx);
+  _lru.clear();
+  _index.clear();
+  _hits = 0;
+  _misses = 0;
+}
+
+} // namespace es
@@ -0,0 +1,67 @@
+// Copyright 2023 watson.wang
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include "euler_spiral.hpp"
+
+#ifndef FIT_CACHE_HPP_
+#define FIT_CACHE_HPP_
+
+namespace es {
+
+struct FitCacheStats {
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t size = 0;
+};
+
+// Memoizes fitSpiral. A spiral's parameters do not change when the (start, goal) pair is
+// translated or rotated, so entries are keyed on the goal pose in the start frame, quantized
+// to positionStep and angleStep. A hit is verified against the exact query; if the cached
+// parameters miss the goal by more than the tolerance they seed a refit, which usually takes
+// one or two iterations and replaces the entry. Least recently used entries are dropped beyond capacity.
+// All members may be called concurrently; fits run outside the lock.
+class FitCache {
+public:
+  explicit FitCache(size_t capacity = 4096, double positionStep = 1.0e-3, double angleStep = 1.0e-5, double tolerance = 1.0e-9);
+
+  FitCache(const FitCache&) = delete;
+  FitCache& operator = (const FitCache&) = delete;
+
+  FitResult fit(const SpiralPoint& start, const SpiralPoint& goal);
+  // same contract as es::getParameter
+  SpiralParameter getParameter(const SpiralPoint& start, const SpiralPoint& goal);
+
+  FitCacheStats stats() const;
+  void clear();
+
+private:
+  struct Key {
+    int64_t x, y, t;
+    bool operator == (const Key& o) const { return x == o.x && y == o.y && t == o.t; }
+  };
+  struct KeyHash {
+    size_t operator () (const Key& k) const;
+  };
+  using Entry = std::pair<Key, SpiralParameter>;
+
+  size_t _capacity;
+  double _invPos, _invAngle;
+  double _tolerance;
+
+  mutable std::mutex _mtx;
+  std::list<Entry> _lru;         // most recently used first
+  std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> _index;
+  size_t _hits, _misses;
+
+  Key makeKey(const SpiralPoint& start, const SpiralPoint& goal) const;
+  bool find(const Key& key, SpiralParameter& param);
+  void insert(const Key& key, const SpiralParameter& param);
+};
+
+} // namespace es
+
+#endif
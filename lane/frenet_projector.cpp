@@ -0,0 +1,102 @@
+// Copyright 2023 watson.wang
+
+#include <cmath>
+#include <algorithm>
+#include "frenet_projector.hpp"
+
+namespace es
+{
+
+FrenetProjector::FrenetProjector(std::shared_ptr<const ReferenceTable> table)
+  : _table(std::move(table)), _warm(false), _node(0) {
+}
+
+double FrenetProjector::distance2(size_t i, double x, double y) const {
+
+  double nx, ny;
+  _table->nodePosition(i, nx, ny);
+  return (x - nx) * (x - nx) + (y - ny) * (y - ny);
+}
+
+size_t FrenetProjector::nearestNode(double x, double y) const {
+
+  size_t best = 0;
+  double bestD = distance2(0, x, y);
+  for (size_t i = 1; i < _table->size(); ++i) {
+    double d = distance2(i, x, y);
+    if (d < bestD) {
+      bestD = d;
+      best = i;
+    }
+  }
+  return best;
+}
+
+size_t FrenetProjector::descend(size_t i, double x, double y) const {
+
+  double d = distance2(i, x, y);
+  while (i + 1 < _table->size()) {
+    double n = distance2(i + 1, x, y);
+    if (n >= d) break;
+    d = n;
+    ++i;
+  }
+  while (i > 0) {
+    double n = distance2(i - 1, x, y);
+    if (n >= d) break;
+    d = n;
+    --i;
+  }
+  return i;
+}
+
+FrenetPoint FrenetProjector::refine(size_t i, double x, double y) const {
+
+  FrenetPoint fp;
+  double s = _table->nodeS(i);
+  for (int it = 0; it < MAX_ITERATIONS; ++it) {
+    ReferencePose r = _table->lookup(s);
+    double dx = x - r.x, dy = y - r.y;
+    double along = dx * r.cosT + dy * r.sinT;
+    fp.d = -dx * r.sinT + dy * r.cosT;
+
+    // near the centre of curvature the closest point is ill defined, take a plain step
+    double den = 1.0 - r.curv * fp.d;
+    double step = den > 0.1 ? along / den : along;
+    step = std::max(-_table->resolution(), std::min(_table->resolution(), step));
+    s += step;
+    if (std::abs(step) < 1.0e-9) break;
+  }
+
+  ReferencePose r = _table->lookup(s);
+  fp.s = s;
+  fp.d = -(x - r.x) * r.sinT + (y - r.y) * r.cosT;
+  return fp;
+}
+
+FrenetPoint FrenetProjector::project(double x, double y) {
+
+  _node = _warm ? descend(_node, x, y) : nearestNode(x, y);
+  _warm = true;
+  return refine(_node, x, y);
+}
+
+FrenetPoint FrenetProjector::project(double x, double y, double sGuess) const {
+
+  double u = (sGuess - _table->begin()) / _table->resolution();
+  size_t i = static_cast<size_t>(std::max(0.0, std::min(u + 0.5, _table->size() - 1.0)));
+  return refine(descend(i, x, y), x, y);
+}
+
+void FrenetProjector::project(const std::vector<double>& x, const std::vector<double>& y, std::vector<double>& s, std::vector<double>& d) {
+
+  s.resize(x.size());
+  d.resize(x.size());
+  for (size_t i = 0; i < x.size(); ++i) {
+    FrenetPoint fp = project(x[i], y[i]);
+    s[i] = fp.s;
+    d[i] = fp.d;
+  }
+}
+
+} // namespace es
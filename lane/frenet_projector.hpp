@@ -0,0 +1,52 @@
+// Copyright 2023 watson.wang
+
+#include <memory>
+#include <vector>
+#include "reference_table.hpp"
+
+#ifndef FRENET_PROJECTOR_HPP_
+#define FRENET_PROJECTOR_HPP_
+
+namespace es {
+
+struct FrenetPoint {
+  double s{}, d{};          // d positive to the left of the reference
+};
+
+// Projects Cartesian points onto a reference table. The closest table node is found by a
+// scan, or by walking downhill from the previous result, then Newton iterations on
+// (p - r(s)) . t(s) = 0 refine s:
+//   ds = (p - r) . t / (1 - k d)
+// Successive queries on nearby points (one vertex after another, one cycle after the next)
+// start from the previous s and take two or three iterations. Not thread safe because of the
+// warm start; use one projector per thread.
+class FrenetProjector {
+public:
+  explicit FrenetProjector(std::shared_ptr<const ReferenceTable> table);
+
+  // warm started from the previous query
+  FrenetPoint project(double x, double y);
+  // started from the node closest to sGuess
+  FrenetPoint project(double x, double y, double sGuess) const;
+  // in order, each point warm starts the next one
+  void project(const std::vector<double>& x, const std::vector<double>& y, std::vector<double>& s, std::vector<double>& d);
+
+  // forget the warm start, the next query scans the whole table
+  void reset() { _warm = false; }
+
+private:
+  static constexpr int MAX_ITERATIONS = 8;
+
+  std::shared_ptr<const ReferenceTable> _table;
+  bool _warm;
+  size_t _node;
+
+  double distance2(size_t i, double x, double y) const;
+  size_t nearestNode(double x, double y) const;
+  size_t descend(size_t i, double x, double y) const;
+  FrenetPoint refine(size_t i, double x, double y) const;
+};
+
+} // namespace es
+
+#endif
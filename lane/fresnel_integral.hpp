@@ -1,11 +1,38 @@
 // modified from https://github.com/CoffeeKumazaki/euler_spiral
 
+#include <cstddef>
+#include <vector>
+
 #ifndef FRESNEL_HPP_
 #define FRESNEL_HPP_
 
 namespace es {
    double fresnel_sin_integral(double x);
    double fresnel_cos_integral(double x);
+
+   // accuracy / cost trade off of the Fresnel pair, the errors are absolute in C and S
+   enum class FresnelPrecision {
+      REFERENCE,   // fresnel_cos_integral / fresnel_sin_integral, bit for bit the original series code
+      DOUBLE,      // the same expansions in plain double, within a few ulp of REFERENCE
+      FAST,        // rational approximations, within FRESNEL_FAST_MAX_ERROR of REFERENCE
+      TABLE,       // DefaultFresnelTable inside its range (see fresnel_table.hpp), DOUBLE outside
+   };
+
+   constexpr double FRESNEL_FAST_MAX_ERROR = 1.0e-10;
+
+   struct FresnelPair {
+      double c;
+      double s;
+   };
+
+   // fresnel_cos_integral and fresnel_sin_integral of one argument, sharing the
+   // range selection, the auxiliary integrals and the sine and cosine
+   FresnelPair fresnel_cs(double x, FresnelPrecision precision = FresnelPrecision::DOUBLE);
+   // batch form: arguments are grouped by range and every group runs as fixed
+   // length loops across the arguments, so the polynomial work vectorizes
+   void fresnel_cs(const double* x, size_t n, double* c, double* s, FresnelPrecision precision = FresnelPrecision::DOUBLE);
+   void fresnel_cs(const std::vector<double>& x, std::vector<double>& c, std::vector<double>& s,
+      FresnelPrecision precision = FresnelPrecision::DOUBLE);
 }
 
-#endif
\ No newline at end of file
+#endif
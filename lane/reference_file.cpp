@@ -0,0 +1,189 @@
+// Copyright 2023 watson.wang
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+#include "reference_file.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace es
+{
+
+namespace {
+
+constexpr char MAGIC[8] = { 'E', 'S', 'R', 'E', 'F', 'L', 'N', '\0' };
+
+uint64_t align8(uint64_t n) {
+
+  return (n + 7) & ~uint64_t(7);
+}
+
+} // namespace
+
+bool writeReferenceFile(const std::string& path, const SpiralRoute& route, double ds) {
+
+  ReferenceTable table(route.window(0.0, 0.0, route.length()), ds);
+
+  // eight buckets per segment on average, a lookup scans forward from its bucket
+  const size_t segments = route.size();
+  const double bucket = std::max(route.length() / (8.0 * segments), 1.0e-3);
+  const size_t buckets = static_cast<size_t>(route.length() / bucket) + 1;
+
+  ReferenceFileHeader hdr{};
+  std::memcpy(hdr.magic, MAGIC, sizeof(MAGIC));
+  hdr.version = REFERENCE_FILE_VERSION;
+  hdr.byteOrder = BYTE_ORDER_MARK;
+  hdr.segmentCount = segments;
+  hdr.segmentOffset = align8(sizeof(ReferenceFileHeader));
+  hdr.bucketCount = buckets;
+  hdr.bucketOffset = align8(hdr.segmentOffset + segments * sizeof(SegmentRecord));
+  hdr.nodeCount = table.size();
+  hdr.nodeOffset = align8(hdr.bucketOffset + buckets * sizeof(uint64_t));
+  hdr.fileSize = hdr.nodeOffset + table.size() * ReferenceTable::STRIDE * sizeof(double);
+  hdr.length = route.length();
+  hdr.invBucket = 1.0 / bucket;
+  hdr.ds = table.resolution();
+  hdr.posError = table.positionErrorBound();
+  hdr.headError = table.headingErrorBound();
+
+  std::vector<char> buf(hdr.fileSize, 0);
+  std::memcpy(buf.data(), &hdr, sizeof(hdr));
+
+  SegmentRecord* rec = reinterpret_cast<SegmentRecord*>(buf.data() + hdr.segmentOffset);
+  for (size_t i = 0; i < segments; ++i) {
+    SpiralPoint p0 = route.segment(i).start();
+    const SpiralParameter& p = route.segment(i).parameter();
+    rec[i] = { p0.x, p0.y, p0.t, route.segmentBegin(i), p.length, p.initCurv, p.dCurv };
+  }
+
+  uint64_t* idx = reinterpret_cast<uint64_t*>(buf.data() + hdr.bucketOffset);
+  for (size_t b = 0; b < buckets; ++b) {
+    idx[b] = route.segmentIndex(b * bucket);
+  }
+
+  std::memcpy(buf.data() + hdr.nodeOffset, table.data(), table.size() * ReferenceTable::STRIDE * sizeof(double));
+
+  std::ofstream out(path, std::ios::binary | std::ios::trunc);
+  out.write(buf.data(), static_cast<std::streamsize>(buf.size()));
+  return static_cast<bool>(out);
+}
+
+struct ReferenceFile::Mapping {
+  const char* data = nullptr;
+  size_t size = 0;
+#ifdef _WIN32
+  HANDLE file = INVALID_HANDLE_VALUE;
+  HANDLE view = nullptr;
+#endif
+
+  explicit Mapping(const std::string& path) {
+#ifdef _WIN32
+    file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) throw std::runtime_error("cannot open " + path);
+    LARGE_INTEGER len;
+    GetFileSizeEx(file, &len);
+    size = static_cast<size_t>(len.QuadPart);
+    view = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!view) {
+      CloseHandle(file);
+      throw std::runtime_error("cannot map " + path);
+    }
+    data = static_cast<const char*>(MapViewOfFile(view, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+      CloseHandle(view);
+      CloseHandle(file);
+      throw std::runtime_error("cannot map " + path);
+    }
+#else
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("cannot open " + path);
+    struct stat st;
+    if (::fstat(fd, &st) != 0 || st.st_size <= 0) {
+      ::close(fd);
+      throw std::runtime_error("cannot stat " + path);
+    }
+    size = static_cast<size_t>(st.st_size);
+    void* p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (p == MAP_FAILED) throw std::runtime_error("cannot map " + path);
+    data = static_cast<const char*>(p);
+#endif
+  }
+
+  ~Mapping() {
+#ifdef _WIN32
+    UnmapViewOfFile(data);
+    CloseHandle(view);
+    CloseHandle(file);
+#else
+    ::munmap(const_cast<char*>(data), size);
+#endif
+  }
+
+  Mapping(const Mapping&) = delete;
+  Mapping& operator = (const Mapping&) = delete;
+};
+
+ReferenceFile::ReferenceFile(const std::string& path)
+  : _map(std::make_shared<const Mapping>(path)) {
+
+  if (_map->size < sizeof(ReferenceFileHeader)) throw std::runtime_error(path + ": too short");
+  _header = reinterpret_cast<const ReferenceFileHeader*>(_map->data);
+
+  const ReferenceFileHeader& h = *_header;
+  if (std::memcmp(h.magic, MAGIC, sizeof(MAGIC)) != 0) throw std::runtime_error(path + ": not a reference file");
+  if (h.version != REFERENCE_FILE_VERSION) throw std::runtime_error(path + ": unsupported version");
+  if (h.byteOrder != BYTE_ORDER_MARK) throw std::runtime_error(path + ": foreign byte order");
+  if (h.fileSize > _map->size) throw std::runtime_error(path + ": truncated");
+
+  auto inside = [&h](uint64_t offset, uint64_t count, uint64_t size) {
+    return offset % 8 == 0 && offset <= h.fileSize && count <= (h.fileSize - offset) / size;
+  };
+  if (h.segmentCount == 0 || h.bucketCount == 0 || h.nodeCount < 2 ||
+      !inside(h.segmentOffset, h.segmentCount, sizeof(SegmentRecord)) ||
+      !inside(h.bucketOffset, h.bucketCount, sizeof(uint64_t)) ||
+      !inside(h.nodeOffset, h.nodeCount, ReferenceTable::STRIDE * sizeof(double))) {
+    throw std::runtime_error(path + ": corrupt block table");
+  }
+
+  _segments = reinterpret_cast<const SegmentRecord*>(_map->data + h.segmentOffset);
+  _buckets = reinterpret_cast<const uint64_t*>(_map->data + h.bucketOffset);
+  _nodes = reinterpret_cast<const double*>(_map->data + h.nodeOffset);
+}
+
+size_t ReferenceFile::segmentIndex(double s) const {
+
+  if (!(s > 0.0)) return 0;
+  size_t b = std::min(static_cast<size_t>(s * _header->invBucket), static_cast<size_t>(_header->bucketCount - 1));
+  size_t i = std::min(static_cast<size_t>(_buckets[b]), size() - 1);
+  while (i + 1 < size() && s >= _segments[i + 1].sBegin) ++i;
+  return i;
+}
+
+SpiralPoint ReferenceFile::evaluate(double s) const {
+
+  const SegmentRecord& r = _segments[segmentIndex(s)];
+  SpiralParameter p;
+  p.length = r.length;
+  p.initCurv = r.initCurv;
+  p.dCurv = r.dCurv;
+  return PreparedSpiral(p, r.x, r.y, r.t).evaluate(s - r.sBegin);
+}
+
+std::shared_ptr<const ReferenceTable> ReferenceFile::table() const {
+
+  return std::make_shared<const ReferenceTable>(_nodes, _header->nodeCount, 0.0, _header->ds,
+                                                _header->posError, _header->headError, _map);
+}
+
+} // namespace es
@@ -0,0 +1,83 @@
+// Copyright 2023 watson.wang
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include "euler_spiral.hpp"
+#include "reference_table.hpp"
+#include "spiral_route.hpp"
+
+#ifndef REFERENCE_FILE_HPP_
+#define REFERENCE_FILE_HPP_
+
+namespace es {
+
+// On disk layout, native endianness, every block 8 byte aligned:
+//   ReferenceFileHeader
+//   SegmentRecord[segmentCount]            fitted spirals with their start pose and route s
+//   uint64_t[bucketCount]                  segment containing route s = i / invBucket
+//   double[nodeCount * ReferenceTable::STRIDE]   dense table nodes from s = 0
+struct ReferenceFileHeader {
+  char magic[8];            // "ESREFLN\0"
+  uint32_t version;
+  uint32_t byteOrder;       // BYTE_ORDER_MARK as written
+  uint64_t fileSize;
+
+  uint64_t segmentCount, segmentOffset;
+  uint64_t bucketCount, bucketOffset;
+  uint64_t nodeCount, nodeOffset;
+
+  double length;            // route length
+  double invBucket;
+  double ds;
+  double posError, headError;
+};
+
+struct SegmentRecord {
+  double x, y, t;           // start pose
+  double sBegin;            // route s of the start
+  double length, initCurv, dCurv;
+};
+
+constexpr uint32_t REFERENCE_FILE_VERSION = 1;
+constexpr uint32_t BYTE_ORDER_MARK = 0x01020304u;
+
+// Writes route and a table at resolution ds over the whole route. Returns false on I/O errors.
+bool writeReferenceFile(const std::string& path, const SpiralRoute& route, double ds);
+
+// Read only memory map of a reference file. Opening validates the header and the block bounds
+// only, so it takes the same time for any map size; pages are loaded on first access. Tables
+// returned by table() view the mapping and keep it alive.
+class ReferenceFile {
+public:
+  // throws std::runtime_error if the file cannot be mapped or is not a valid reference file
+  explicit ReferenceFile(const std::string& path);
+
+  ReferenceFile(const ReferenceFile&) = delete;
+  ReferenceFile& operator = (const ReferenceFile&) = delete;
+
+  const ReferenceFileHeader& header() const { return *_header; }
+  size_t size() const { return _header->segmentCount; }
+  double length() const { return _header->length; }
+
+  const SegmentRecord& segment(size_t i) const { return _segments[i]; }
+  size_t segmentIndex(double s) const;
+  // exact evaluation of the fitted spiral
+  SpiralPoint evaluate(double s) const;
+
+  std::shared_ptr<const ReferenceTable> table() const;
+
+private:
+  struct Mapping;
+  std::shared_ptr<const Mapping> _map;
+
+  const ReferenceFileHeader* _header;
+  const SegmentRecord* _segments;
+  const uint64_t* _buckets;
+  const double* _nodes;
+};
+
+} // namespace es
+
+#endif
@@ -0,0 +1,176 @@
+// Copyright 2023 watson.wang
+
+#include <cmath>
+#include <algorithm>
+#include "reference_table.hpp"
+
+namespace es
+{
+
+namespace {
+
+// Cubic Hermite remainder: |f - H| <= h^4 / 384 * max |f''''| on every interval.
+// With theta' = k and theta'' = k' constant, the fourth derivative of the position is the third
+// derivative of the unit tangent, |(3 k k') + i k^3|, and the one of the tangent is
+// |k^4 - 3 k'^2 - 6 i k^2 k'|.
+void errorBounds(double kMax, double dk, double h, double& pos, double& head) {
+
+  double h4 = h * h * h * h / 384.0;
+  pos = h4 * (3.0 * kMax * std::abs(dk) + kMax * kMax * kMax);
+  head = h4 * (kMax * kMax * kMax * kMax + 3.0 * dk * dk + 6.0 * kMax * kMax * std::abs(dk));
+}
+
+// A curvature step dk at a segment joint adds dk (t - t0)+^2 / 2 to the position and dk (t - t0)+
+// to the tangent, whose Hermite interpolation errors peak at 0.0162 h^2 dk and 0.147 h dk.
+// A dCurv step ddk adds ddk (t - t0)+^3 / 6 and ddk (t - t0)+^2 / 2, peaking at h^3 ddk / 192 and
+// 0.0162 h^2 ddk.
+void jumpBounds(double jump, double dJump, double h, double& pos, double& head) {
+
+  pos += h * h * jump / 60.0 + h * h * h * dJump / 192.0;
+  head += h * jump * 0.15 + h * h * dJump / 60.0;
+}
+
+double maxCurvature(const PreparedSpiral& spiral, double sBegin, double sEnd) {
+
+  return std::max(std::abs(spiral.curvature(sBegin)), std::abs(spiral.curvature(sEnd)));
+}
+
+} // namespace
+
+template <class Source>
+void ReferenceTable::sample(const Source& source) {
+
+  _n = std::max<size_t>(_n, 2);
+  _nodes.resize(_n * STRIDE);
+  _data = _nodes.data();
+  for (size_t i = 0; i < _n; ++i) {
+    double s = _s0 + i * _ds;
+    SpiralPoint pos = source.evaluate(s);
+    double* p = _nodes.data() + i * STRIDE;
+    p[0] = pos.x;
+    p[1] = pos.y;
+    p[2] = std::cos(pos.t);
+    p[3] = std::sin(pos.t);
+    p[4] = source.curvature(s);
+  }
+}
+
+ReferenceTable::ReferenceTable(const PreparedSpiral& spiral, double sBegin, double sEnd, double ds)
+  : _s0(sBegin), _ds(ds), _invDs(1.0 / ds), _n(static_cast<size_t>(std::ceil((sEnd - sBegin) / ds)) + 1), _data(nullptr) {
+
+  sample(spiral);
+  errorBounds(maxCurvature(spiral, sBegin, end()), spiral.parameter().dCurv, _ds, _posError, _headError);
+}
+
+ReferenceTable::ReferenceTable(const SpiralRouteWindow& window, double ds)
+  : _s0(window.begin()), _ds(ds), _invDs(1.0 / ds), _n(static_cast<size_t>(std::ceil((window.end() - window.begin()) / ds)) + 1),
+    _data(nullptr) {
+
+  sample(window);
+  errorBounds(window.maxCurvature(), window.maxDCurv(), _ds, _posError, _headError);
+  jumpBounds(window.maxCurvatureJump(), window.maxDCurvJump(), _ds, _posError, _headError);
+}
+
+ReferenceTable::ReferenceTable(const double* nodes, size_t n, double sBegin, double ds, double posError, double headError,
+                               std::shared_ptr<const void> owner)
+  : _s0(sBegin), _ds(ds), _invDs(1.0 / ds), _n(n), _data(nodes), _owner(std::move(owner)),
+    _posError(posError), _headError(headError) {
+}
+
+ReferenceTable::ReferenceTable(const ReferenceTable& other)
+  : _s0(other._s0), _ds(other._ds), _invDs(other._invDs), _n(other._n), _nodes(other._nodes),
+    _data(_nodes.empty() ? other._data : _nodes.data()), _owner(other._owner),
+    _posError(other._posError), _headError(other._headError) {
+}
+
+ReferenceTable& ReferenceTable::operator = (const ReferenceTable& other) {
+
+  if (this != &other) {
+    ReferenceTable copy(other);
+    *this = std::move(copy);
+  }
+  return *this;
+}
+
+double ReferenceTable::resolutionFor(const PreparedSpiral& spiral, double sBegin, double sEnd, double tolerance) {
+
+  double pos, head;
+  errorBounds(maxCurvature(spiral, sBegin, sEnd), spiral.parameter().dCurv, 1.0, pos, head);
+  if (pos <= 0.0) return sEnd - sBegin;
+  return std::pow(tolerance / pos, 0.25);
+}
+
+double ReferenceTable::resolutionFor(const SpiralRouteWindow& window, double tolerance) {
+
+  auto bound = [&window](double h) {
+    double pos, head;
+    errorBounds(window.maxCurvature(), window.maxDCurv(), h, pos, head);
+    jumpBounds(window.maxCurvatureJump(), window.maxDCurvJump(), h, pos, head);
+    return pos;
+  };
+
+  // the bound grows monotonically in h
+  double lo = 0.0, hi = std::max(window.end() - window.begin(), tolerance);
+  if (bound(hi) <= tolerance) return hi;
+  for (int i = 0; i < 60; ++i) {
+    double mid = 0.5 * (lo + hi);
+    (bound(mid) <= tolerance ? lo : hi) = mid;
+  }
+  return lo;
+}
+
+ReferencePose ReferenceTable::lookup(double s) const {
+
+  ReferencePose pose;
+  double u = (s - _s0) * _invDs;
+
+  if (u <= 0.0 || u >= _n - 1) {
+    const double* p = u <= 0.0 ? node(0) : node(_n - 1);
+    double ds = u <= 0.0 ? s - _s0 : s - end();
+    pose.x = p[0] + ds * p[2];
+    pose.y = p[1] + ds * p[3];
+    pose.cosT = p[2];
+    pose.sinT = p[3];
+    pose.curv = p[4];
+    return pose;
+  }
+
+  size_t i = static_cast<size_t>(u);
+  double t = u - i;
+  const double* p0 = node(i);
+  const double* p1 = p0 + STRIDE;
+
+  double t2 = t * t;
+  double omt = 1.0 - t;
+  double h00 = (1.0 + 2.0 * t) * omt * omt;
+  double h10 = t * omt * omt * _ds;
+  double h01 = t2 * (3.0 - 2.0 * t);
+  double h11 = t2 * (t - 1.0) * _ds;
+
+  pose.x = h00 * p0[0] + h10 * p0[2] + h01 * p1[0] + h11 * p1[2];
+  pose.y = h00 * p0[1] + h10 * p0[3] + h01 * p1[1] + h11 * p1[3];
+  pose.cosT = h00 * p0[2] - h10 * p0[4] * p0[3] + h01 * p1[2] - h11 * p1[4] * p1[3];
+  pose.sinT = h00 * p0[3] + h10 * p0[4] * p0[2] + h01 * p1[3] + h11 * p1[4] * p1[2];
+  pose.curv = p0[4] + t * (p1[4] - p0[4]);
+  pose.dCurv = (p1[4] - p0[4]) * _invDs;
+
+  return pose;
+}
+
+void ReferenceTable::lookup(const std::vector<double>& s, std::vector<double>& x, std::vector<double>& y,
+                            std::vector<double>& cosT, std::vector<double>& sinT) const {
+
+  x.resize(s.size());
+  y.resize(s.size());
+  cosT.resize(s.size());
+  sinT.resize(s.size());
+  for (size_t i = 0; i < s.size(); ++i) {
+    ReferencePose pose = lookup(s[i]);
+    x[i] = pose.x;
+    y[i] = pose.y;
+    cosT[i] = pose.cosT;
+    sinT[i] = pose.sinT;
+  }
+}
+
+} // namespace es
@@ -0,0 +1,80 @@
+// Copyright 2023 watson.wang
+
+#include <memory>
+#include <vector>
+#include "spiral_evaluator.hpp"
+#include "spiral_route.hpp"
+
+#ifndef REFERENCE_TABLE_HPP_
+#define REFERENCE_TABLE_HPP_
+
+namespace es {
+
+struct ReferencePose {
+  double x{}, y{};
+  double cosT{}, sinT{};
+  double curv{};
+  double dCurv{};
+};
+
+// Reference line sampled once at a fixed s resolution, storing x, y, cos, sin and curvature per node.
+// Position and heading are cubic Hermite interpolated with the node headings and curvatures as
+// derivatives, curvature is linear. Built once per reference line, then read only, so one table
+// can be shared across planning cycles and threads. Outside [begin, end] the pose continues along
+// the end tangent.
+class ReferenceTable {
+public:
+  ReferenceTable(const PreparedSpiral& spiral, double sBegin, double sEnd, double ds);
+  // route window in route s; the error bounds include the curvature steps between segments
+  ReferenceTable(const SpiralRouteWindow& window, double ds);
+  // view of STRIDE doubles per node stored elsewhere (e.g. a mapped ReferenceFile), owner keeps
+  // that memory alive for the lifetime of the table
+  ReferenceTable(const double* nodes, size_t n, double sBegin, double ds, double posError, double headError,
+                 std::shared_ptr<const void> owner);
+
+  ReferenceTable(const ReferenceTable& other);
+  ReferenceTable& operator = (const ReferenceTable& other);
+  ReferenceTable(ReferenceTable&&) noexcept = default;
+  ReferenceTable& operator = (ReferenceTable&&) noexcept = default;
+
+  ReferencePose lookup(double s) const;
+  void lookup(const std::vector<double>& s, std::vector<double>& x, std::vector<double>& y,
+              std::vector<double>& cosT, std::vector<double>& sinT) const;
+
+  // largest interpolation error inside [begin, end], in metres for position and in
+  // unit vector length for (cos, sin)
+  double positionErrorBound() const { return _posError; }
+  double headingErrorBound() const { return _headError; }
+
+  double begin() const { return _s0; }
+  double end() const { return _s0 + _ds * (_n - 1); }
+  double resolution() const { return _ds; }
+  size_t size() const { return _n; }
+  double nodeS(size_t i) const { return _s0 + i * _ds; }
+  void nodePosition(size_t i, double& x, double& y) const { x = node(i)[0]; y = node(i)[1]; }
+
+  // coarsest resolution whose position error bound stays below tolerance
+  static double resolutionFor(const PreparedSpiral& spiral, double sBegin, double sEnd, double tolerance);
+  static double resolutionFor(const SpiralRouteWindow& window, double tolerance);
+
+  // doubles per node: x, y, cos, sin, curv
+  static constexpr size_t STRIDE = 5;
+  const double* data() const { return _data; }
+
+private:
+  double _s0, _ds, _invDs;
+  size_t _n;
+  std::vector<double> _nodes;     // owned nodes, empty for a view
+  const double* _data;            // _nodes or the viewed memory
+  std::shared_ptr<const void> _owner;
+  double _posError, _headError;
+
+  const double* node(size_t i) const { return _data + i * STRIDE; }
+
+  template <class Source>
+  void sample(const Source& source);
+};
+
+} // namespace es
+
+#endif
@@ -0,0 +1,231 @@
+// Copyright 2023 watson.wang
+
+#include <cmath>
+#include <corecrt_math_defines.h>
+#include "spiral_evaluator.hpp"
+#include "fresnel_integral.hpp"
+
+namespace es
+{
+
+PreparedSpiral::PreparedSpiral(const SpiralParameter& param, double initX, double initY, double initTheta, FresnelPrecision precision)
+  : _param(param), _initX(initX), _initY(initY), _initTheta(initTheta), _kind(Kind::CLOTHOID), _precision(precision),
+    _cosT(std::cos(initTheta)), _sinT(std::sin(initTheta)), _cosI(_cosT), _sinI(_sinT), _a(0.0), _scale(0.0), _sign(1.0), _c0(0.0), _s0(0.0) {
+
+  if (param.dCurv == 0.0 && param.initCurv == 0.0) {
+    _kind = Kind::LINE;
+  }
+  else if (param.dCurv == 0.0) {
+    _kind = Kind::ARC;
+    _scale = 1.0 / param.initCurv;
+  }
+  else {
+    _a = 1.0 / std::sqrt(M_PI * std::abs(param.dCurv));
+    _scale = M_PI * _a;
+    _sign = param.dCurv < 0.0 ? -1.0 : 1.0;
+    FresnelPair f0 = fresnel_cs(param.initCurv * _a, _precision);
+    _c0 = f0.c;
+    _s0 = f0.s;
+
+    double theta = initTheta - param.initCurv * param.initCurv * 0.5 / param.dCurv;
+    _cosT = std::cos(theta);
+    _sinT = std::sin(theta);
+  }
+}
+
+void PreparedSpiral::point(double s, double& x, double& y) const {
+
+  double lx, ly;
+  switch (_kind) {
+  case Kind::LINE:
+    lx = s;
+    ly = 0.0;
+    break;
+  case Kind::ARC:
+    lx = std::sin(_param.initCurv * s) * _scale;
+    ly = (1.0 - std::cos(_param.initCurv * s)) * _scale;
+    break;
+  default: {
+    if (useSeriesOffset(s, _param.dCurv, _param.initCurv)) {
+      getSeriesOffset(s, _param.dCurv, _param.initCurv, lx, ly);
+      x = _initX + lx * _cosI - ly * _sinI;
+      y = _initY + lx * _sinI + ly * _cosI;
+      return;
+    }
+    FresnelPair f = fresnel_cs((_param.initCurv + _param.dCurv * s) * _a, _precision);
+    lx = _sign * (f.c - _c0) * _scale;
+    ly = (f.s - _s0) * _scale;
+    break;
+  }
+  }
+
+  x = _initX + lx * _cosT - ly * _sinT;
+  y = _initY + lx * _sinT + ly * _cosT;
+}
+
+SpiralPoint PreparedSpiral::evaluate(double s) const {
+
+  SpiralPoint pos;
+  point(s, pos.x, pos.y);
+  pos.t = heading(s);
+  return pos;
+}
+
+void PreparedSpiral::evaluate(const std::vector<double>& s, std::vector<double>& x, std::vector<double>& y, std::vector<double>& theta) const {
+
+  x.resize(s.size());
+  y.resize(s.size());
+  theta.resize(s.size());
+  for (size_t i = 0; i < s.size(); ++i) {
+    theta[i] = heading(s[i]);
+  }
+
+  if (_kind != Kind::CLOTHOID) {
+    for (size_t i = 0; i < s.size(); ++i) {
+      point(s[i], x[i], y[i]);
+    }
+    return;
+  }
+
+  // the series samples are done one by one, the rest share one batch Fresnel call
+  std::vector<size_t> idx;
+  std::vector<double> u, c, sn;
+  idx.reserve(s.size());
+  u.reserve(s.size());
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (useSeriesOffset(s[i], _param.dCurv, _param.initCurv)) {
+      point(s[i], x[i], y[i]);
+    }
+    else {
+      idx.push_back(i);
+      u.push_back((_param.initCurv + _param.dCurv * s[i]) * _a);
+    }
+  }
+
+  fresnel_cs(u, c, sn, _precision);
+  for (size_t j = 0; j < idx.size(); ++j) {
+    double lx = _sign * (c[j] - _c0) * _scale;
+    double ly = (sn[j] - _s0) * _scale;
+    x[idx[j]] = _initX + lx * _cosT - ly * _sinT;
+    y[idx[j]] = _initY + lx * _sinT + ly * _cosT;
+  }
+}
+
+SpiralWalker::SpiralWalker(const PreparedSpiral& spiral, size_t resyncInterval)
+  : _spiral(spiral), _interval(resyncInterval), _steps(0), _maxDStep(HUGE_VAL), _s(0.0), _x(0.0), _y(0.0), _c(1.0), _sn(0.0) {
+
+  const SpiralParameter& p = spiral.parameter();
+  if (p.dCurv != 0.0) _maxDStep = std::sqrt(0.5 / std::abs(p.dCurv));
+
+  // a line or an arc is evaluated exactly for about the price of a step
+  if (p.dCurv == 0.0) _interval = 0;
+
+  reset(0.0);
+}
+
+void SpiralWalker::reset(double s) {
+
+  SpiralPoint pos = _spiral.evaluate(s);
+  _s = s;
+  _x = pos.x;
+  _y = pos.y;
+  _c = std::cos(pos.t);
+  _sn = std::sin(pos.t);
+  _steps = 0;
+}
+
+void SpiralWalker::advance(double s) {
+
+  if (_interval == 0 || ++_steps >= _interval) {
+    reset(s);
+    return;
+  }
+
+  double h = s - _s;
+  const double bound = maxStep(_s, s);
+  if (std::abs(h) <= bound) {
+    step(h);
+  }
+  else {
+    int n = static_cast<int>(std::ceil(std::abs(h) / bound));
+    for (int i = 0; i < n; ++i) {
+      step(h / n);
+    }
+  }
+  _s = s;
+}
+
+double SpiralWalker::maxStep(double a, double b) const {
+
+  // curvature is linear in s, also where the spiral is continued past [0, length], so its
+  // largest magnitude between a and b is at one of them
+  double k = std::max(std::abs(_spiral.curvature(a)), std::abs(_spiral.curvature(b)));
+  return k > 0.0 ? std::min(_maxDStep, 0.5 / k) : _maxDStep;
+}
+
+void SpiralWalker::step(double h) {
+
+  // g(t) = exp(i phi(t)), phi = k t + k' t^2 / 2, g' = i (k + k' t) g, so its Taylor
+  // coefficients follow (m + 1) c[m+1] = i (k c[m] + k' c[m-1]).
+  // The rotation is g(h) = sum c[m] h^m and the displacement int_0^h g = sum c[m] h^(m+1) / (m+1).
+  // with |k h|, |k' h^2| <= 0.5 the terms after ORDER are below 1e-11 h; small steps stop
+  // as soon as the terms no longer change the sum
+  static constexpr int ORDER = 10;
+  static constexpr double INV[ORDER + 2] = { 1.0, 1.0, 1.0 / 2, 1.0 / 3, 1.0 / 4, 1.0 / 5, 1.0 / 6,
+                                             1.0 / 7, 1.0 / 8, 1.0 / 9, 1.0 / 10, 1.0 / 11 };
+
+  const double kh = _spiral.curvature(_s) * h;
+  const double dkh2 = _spiral.parameter().dCurv * h * h;
+
+  // c[m] h^m, real and imaginary parts
+  double pr = 0.0, pi = 0.0;          // m - 1
+  double cr = 1.0, ci = 0.0;          // m
+  double rr = 1.0, ri = 0.0;          // rotation
+  double dr = 1.0, di = 0.0;          // displacement / h
+
+  for (int m = 0; m < ORDER; ++m) {
+    // i (kh c + dkh2 p) / (m + 1)
+    double nr = -(kh * ci + dkh2 * pi) * INV[m + 1];
+    double ni = (kh * cr + dkh2 * pr) * INV[m + 1];
+    pr = cr; pi = ci;
+    cr = nr; ci = ni;
+
+    rr += cr; ri += ci;
+    dr += cr * INV[m + 2]; di += ci * INV[m + 2];
+    if (std::abs(cr) + std::abs(ci) + std::abs(pr) + std::abs(pi) < 1.0e-17) break;
+  }
+
+  dr *= h;
+  di *= h;
+  _x += dr * _c - di * _sn;
+  _y += dr * _sn + di * _c;
+
+  double c = _c * rr - _sn * ri;
+  double sn = _c * ri + _sn * rr;
+  _c = c;
+  _sn = sn;
+  _s += h;
+}
+
+void SpiralWalker::walk(const std::vector<double>& s, std::vector<double>& x, std::vector<double>& y,
+                        std::vector<double>& cosT, std::vector<double>& sinT) {
+
+  x.resize(s.size());
+  y.resize(s.size());
+  cosT.resize(s.size());
+  sinT.resize(s.size());
+  for (size_t i = 0; i < s.size(); ++i) {
+    if (i == 0) {
+      reset(s[i]);
+    }
+    else {
+      advance(s[i]);
+    }
+    x[i] = _x;
+    y[i] = _y;
+    cosT[i] = _c;
+    sinT[i] = _sn;
+  }
+}
+
+} // namespace es
@@ -0,0 +1,84 @@
+// Copyright 2023 watson.wang
+
+#include <vector>
+#include "euler_spiral.hpp"
+
+#ifndef SPIRAL_EVALUATOR_HPP_
+#define SPIRAL_EVALUATOR_HPP_
+
+namespace es {
+
+// Euler spiral with every per spiral invariant of getEndPoint computed once:
+// the Fresnel scale, the rotated frame and the Fresnel pair at the start.
+// Evaluating a point then costs one Fresnel pair (or one sin/cos on an arc); near straight and
+// near arc points use the series of getSeriesOffset instead (see useSeriesOffset).
+class PreparedSpiral {
+public:
+  explicit PreparedSpiral(const SpiralParameter& param, double initX = 0.0, double initY = 0.0, double initTheta = 0.0,
+                          FresnelPrecision precision = FresnelPrecision::DOUBLE);
+
+  SpiralPoint evaluate(double s) const;
+  void evaluate(const std::vector<double>& s, std::vector<double>& x, std::vector<double>& y, std::vector<double>& theta) const;
+
+  double heading(double s) const { return _initTheta + _param.initCurv * s + 0.5 * _param.dCurv * s * s; }
+  double curvature(double s) const { return _param.initCurv + _param.dCurv * s; }
+
+  const SpiralParameter& parameter() const { return _param; }
+  SpiralPoint start() const { return { _initX, _initY, _initTheta }; }
+  FresnelPrecision precision() const { return _precision; }
+
+private:
+  enum class Kind { LINE, ARC, CLOTHOID };
+
+  SpiralParameter _param;
+  double _initX, _initY, _initTheta;
+  Kind _kind;
+  FresnelPrecision _precision;
+
+  double _cosT, _sinT;       // rotation of the local frame
+  double _cosI, _sinI;       // rotation of the start pose
+  double _a;                 // 1 / sqrt(pi |dCurv|)
+  double _scale;             // pi * a, or 1 / initCurv on an arc
+  double _sign;              // mirror for dCurv < 0
+  double _c0, _s0;           // Fresnel pair at initCurv * a
+
+  void point(double s, double& x, double& y) const;
+};
+
+// Walks a prepared spiral through a sequence of nearby arc lengths. Each step integrates the
+// local clothoid exp(i (k t + k' t^2 / 2)) with a truncated Taylor series in the step length,
+// which costs a few multiply-adds instead of a Fresnel pair. Every resyncInterval steps the
+// pose is re-evaluated exactly so the accumulated drift stays bounded.
+class SpiralWalker {
+public:
+  explicit SpiralWalker(const PreparedSpiral& spiral, size_t resyncInterval = 8);
+
+  // exact evaluation at s
+  void reset(double s);
+  // move from the current s to s
+  void advance(double s);
+
+  double s() const { return _s; }
+  double x() const { return _x; }
+  double y() const { return _y; }
+  double cosT() const { return _c; }
+  double sinT() const { return _sn; }
+
+  void walk(const std::vector<double>& s, std::vector<double>& x, std::vector<double>& y,
+            std::vector<double>& cosT, std::vector<double>& sinT);
+
+private:
+  const PreparedSpiral& _spiral;
+  size_t _interval;
+  size_t _steps;
+  double _maxDStep;          // keeps |k' h^2| below 0.5
+  double _s, _x, _y, _c, _sn;
+
+  void step(double h);
+  // keeps |k h| below 0.5 between a and b as well, past the ends included
+  double maxStep(double a, double b) const;
+};
+
+} // namespace es
+
+#endif
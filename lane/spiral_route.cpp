@@ -0,0 +1,189 @@
+// Copyright 2023 watson.wang
+
+#include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include "spiral_route.hpp"
+
+namespace es
+{
+
+RouteFitReport fitRoute(const std::vector<SpiralPoint>& waypoints, size_t threads, FitCache* cache, double tolerance) {
+
+  RouteFitReport report;
+  const size_t num = waypoints.size() > 1 ? waypoints.size() - 1 : 0;
+  report.segments.resize(num);
+
+  // workers claim small chunks of segments and write to their own slots
+  static constexpr size_t CHUNK = 16;
+  std::atomic<size_t> next{ 0 };
+  auto work = [&]() {
+    for (size_t begin = next.fetch_add(CHUNK); begin < num; begin = next.fetch_add(CHUNK)) {
+      for (size_t i = begin; i < std::min(begin + CHUNK, num); ++i) {
+        report.segments[i] = cache ? cache->fit(waypoints[i], waypoints[i + 1])
+                                   : fitSpiral(waypoints[i], waypoints[i + 1], nullptr, 50, tolerance);
+      }
+    }
+  };
+
+  if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+  threads = std::min(threads, (num + CHUNK - 1) / CHUNK);
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < threads; ++t) {
+    pool.emplace_back(work);
+  }
+  work();
+  for (auto& th : pool) {
+    th.join();
+  }
+
+  for (size_t i = 0; i < num; ++i) {
+    report.iterations += report.segments[i].iterations;
+    if (!report.segments[i].converged) report.flagged.push_back(i);
+  }
+  return report;
+}
+
+SpiralRoute::SpiralRoute(const std::vector<SpiralPoint>& waypoints, FitCache* cache)
+  : _invBucket(0.0) {
+
+  std::vector<SpiralParameter> params;
+  for (size_t i = 0; i + 1 < waypoints.size(); ++i) {
+    params.push_back(cache ? cache->getParameter(waypoints[i], waypoints[i + 1]) : getParameter(waypoints[i], waypoints[i + 1]));
+  }
+  build(waypoints, params);
+}
+
+SpiralRoute::SpiralRoute(const std::vector<SpiralPoint>& waypoints, const RouteFitReport& fit)
+  : _invBucket(0.0) {
+
+  std::vector<SpiralParameter> params;
+  for (const FitResult& f : fit.segments) {
+    params.push_back(f.param);
+  }
+  build(waypoints, params);
+}
+
+void SpiralRoute::build(const std::vector<SpiralPoint>& waypoints, const std::vector<SpiralParameter>& params) {
+
+  _s.push_back(0.0);
+  for (size_t i = 0; i < params.size(); ++i) {
+    const SpiralPoint& a = waypoints[i];
+    _segments.emplace_back(params[i], a.x, a.y, a.t);
+    _s.push_back(_s.back() + params[i].length);
+  }
+
+  if (_segments.empty()) {
+    _segments.emplace_back(SpiralParameter(), waypoints.empty() ? 0.0 : waypoints[0].x,
+                           waypoints.empty() ? 0.0 : waypoints[0].y, waypoints.empty() ? 0.0 : waypoints[0].t);
+    _s.push_back(0.0);
+    _buckets.push_back(0);
+    return;
+  }
+
+  // buckets no shorter than the shortest segment, so a bucket usually holds one or two segments,
+  // and at most eight per segment, so a very short one does not blow the grid up. Buckets that
+  // still cover many short segments are binary searched
+  double minLen = length();
+  for (size_t i = 0; i < _segments.size(); ++i) {
+    minLen = std::min(minLen, _s[i + 1] - _s[i]);
+  }
+  double bucket = std::max(minLen, length() / (8.0 * _segments.size()));
+  size_t num = static_cast<size_t>(std::ceil(length() / bucket)) + 1;
+  _invBucket = 1.0 / bucket;
+
+  _buckets.resize(num);
+  size_t seg = 0;
+  for (size_t b = 0; b < num; ++b) {
+    double s = b * bucket;
+    while (seg + 1 < _segments.size() && s >= _s[seg + 1]) ++seg;
+    _buckets[b] = seg;
+  }
+}
+
+size_t SpiralRoute::segmentIndex(double s) const {
+
+  if (!(s > 0.0)) return 0;
+  size_t b = std::min(static_cast<size_t>(s * _invBucket), _buckets.size() - 1);
+  // s lies in one of the segments from the one at the bucket begin to the one at the next bucket begin
+  size_t first = _buckets[b];
+  size_t last = b + 1 < _buckets.size() ? _buckets[b + 1] : _segments.size() - 1;
+  auto it = std::upper_bound(_s.begin() + first + 1, _s.begin() + last + 1, s);
+  return static_cast<size_t>(it - _s.begin()) - 1;
+}
+
+SpiralPoint SpiralRoute::evaluate(double s) const {
+
+  size_t i = segmentIndex(s);
+  return _segments[i].evaluate(s - _s[i]);
+}
+
+double SpiralRoute::curvature(double s) const {
+
+  size_t i = segmentIndex(s);
+  return _segments[i].curvature(s - _s[i]);
+}
+
+SpiralRouteWindow SpiralRoute::window(double s, double behind, double ahead) const {
+
+  return SpiralRouteWindow(*this, std::max(0.0, s - behind), std::min(length(), s + ahead));
+}
+
+SpiralRouteWindow::SpiralRouteWindow(const SpiralRoute& route, double sBegin, double sEnd)
+  : _route(&route), _s0(sBegin), _s1(std::max(sBegin, sEnd)),
+    _first(route.segmentIndex(sBegin)), _last(route.segmentIndex(std::max(sBegin, sEnd))) {
+}
+
+SpiralPoint SpiralRouteWindow::evaluate(double s) const {
+
+  return _route->evaluate(s);
+}
+
+double SpiralRouteWindow::curvature(double s) const {
+
+  return _route->curvature(s);
+}
+
+double SpiralRouteWindow::maxCurvature() const {
+
+  double k = 0.0;
+  for (size_t i = _first; i <= _last; ++i) {
+    const PreparedSpiral& seg = _route->segment(i);
+    double a = std::max(_s0, _route->segmentBegin(i)) - _route->segmentBegin(i);
+    double b = std::min(_s1, _route->segmentBegin(i + 1)) - _route->segmentBegin(i);
+    k = std::max({ k, std::abs(seg.curvature(a)), std::abs(seg.curvature(b)) });
+  }
+  return k;
+}
+
+double SpiralRouteWindow::maxDCurv() const {
+
+  double dk = 0.0;
+  for (size_t i = _first; i <= _last; ++i) {
+    dk = std::max(dk, std::abs(_route->segment(i).parameter().dCurv));
+  }
+  return dk;
+}
+
+double SpiralRouteWindow::maxCurvatureJump() const {
+
+  double jump = 0.0;
+  for (size_t i = _first; i < _last; ++i) {
+    const SpiralParameter& p = _route->segment(i).parameter();
+    double k0 = p.initCurv + p.dCurv * p.length;
+    jump = std::max(jump, std::abs(_route->segment(i + 1).parameter().initCurv - k0));
+  }
+  return jump;
+}
+
+double SpiralRouteWindow::maxDCurvJump() const {
+
+  double jump = 0.0;
+  for (size_t i = _first; i < _last; ++i) {
+    jump = std::max(jump, std::abs(_route->segment(i + 1).parameter().dCurv - _route->segment(i).parameter().dCurv));
+  }
+  return jump;
+}
+
+} // namespace es
@@ -0,0 +1,89 @@
+// Copyright 2023 watson.wang
+
+#include <cstddef>
+#include <vector>
+#include "euler_spiral.hpp"
+#include "spiral_evaluator.hpp"
+#include "fit_cache.hpp"
+
+#ifndef SPIRAL_ROUTE_HPP_
+#define SPIRAL_ROUTE_HPP_
+
+namespace es {
+
+class SpiralRoute;
+
+struct RouteFitReport {
+  std::vector<FitResult> segments;   // one per waypoint pair, in route order
+  std::vector<size_t> flagged;       // segments that did not reach the tolerance, ascending
+  size_t iterations = 0;             // over all segments
+};
+
+// Fits every waypoint pair with fitSpiral on up to threads workers (0 uses every core).
+// The report does not depend on the thread count or scheduling. cache is optional, fits
+// through it use its own tolerance.
+RouteFitReport fitRoute(const std::vector<SpiralPoint>& waypoints, size_t threads = 0, FitCache* cache = nullptr, double tolerance = 1.0e-9);
+
+// Part of a route around the ego, [begin, end] in route s. Only refers to the route, so
+// building one costs two segment lookups whatever the route length.
+class SpiralRouteWindow {
+public:
+  SpiralRouteWindow(const SpiralRoute& route, double sBegin, double sEnd);
+
+  double begin() const { return _s0; }
+  double end() const { return _s1; }
+  size_t firstSegment() const { return _first; }
+  size_t lastSegment() const { return _last; }
+  const SpiralRoute& route() const { return *_route; }
+
+  SpiralPoint evaluate(double s) const;
+  double curvature(double s) const;
+
+  // largest |curvature|, |dCurv| and step of curvature and dCurv between segments inside the window
+  double maxCurvature() const;
+  double maxDCurv() const;
+  double maxCurvatureJump() const;
+  double maxDCurvJump() const;
+
+private:
+  const SpiralRoute* _route;
+  double _s0, _s1;
+  size_t _first, _last;
+};
+
+// Piecewise clothoid through a list of waypoints, one getParameter fit per pair. Route s is
+// cumulative over the segments; a uniform bucket grid over s narrows a sample down to the
+// segments of one bucket, usually one or two, which are binary searched. Before the first and
+// after the last segment the end segments continue.
+class SpiralRoute {
+public:
+  // cache is optional and may be shared between routes
+  explicit SpiralRoute(const std::vector<SpiralPoint>& waypoints, FitCache* cache = nullptr);
+  // from a fitRoute report of the same waypoints
+  SpiralRoute(const std::vector<SpiralPoint>& waypoints, const RouteFitReport& fit);
+
+  size_t size() const { return _segments.size(); }
+  double length() const { return _s.back(); }
+
+  size_t segmentIndex(double s) const;
+  double segmentBegin(size_t i) const { return _s[i]; }
+  const PreparedSpiral& segment(size_t i) const { return _segments[i]; }
+
+  SpiralPoint evaluate(double s) const;
+  double curvature(double s) const;
+
+  // behind and ahead of s, clipped to the route
+  SpiralRouteWindow window(double s, double behind, double ahead) const;
+
+private:
+  std::vector<PreparedSpiral> _segments;
+  std::vector<double> _s;                // segment begin, plus the route length
+  double _invBucket;
+  std::vector<size_t> _buckets;          // segment containing the bucket begin
+
+  void build(const std::vector<SpiralPoint>& waypoints, const std::vector<SpiralParameter>& params);
+};
+
+} // namespace es
+
+#endif
@@ -6,6 +6,8 @@
 #include <fstream>
 #include <algorithm>
 #include "lattice.hpp"
+#include "emergency.hpp"
+#include "planner_service.hpp"
 #include "polynomials.hpp"
 
 int main()
@@ -59,6 +61,7 @@ int main()
     auto obj = make_shared<ob::Constraints>();
     obj->static_obstacles.push_back(ob::stationaryObj(obstacle(rawpoints[20], off1, 3.5, 5.0)));
     obj->static_obstacles.push_back(ob::stationaryObj(obstacle(rawpoints[55], off2, 3.5, 5.0)));
+    obj->buildIndex();
 
     for (auto oo : obj->static_obstacles) {
        obf << dsv(oo.getPoly()) << endl;
@@ -101,10 +104,18 @@ int main()
     //fr::FrenetPath  pth(para, p, initSts);
     //auto ans = pth.generatePath();
 
+    const fr::Status initSts = newSts;
     vector<fr::Trajectory> ans;
+    auto emergency = make_shared<const fr::EmergencyLibrary>(para);
+
+    es::PreparedSpiral ref(p, start.x, start.y, start.t);
+    auto table = make_shared<const es::ReferenceTable>(ref, 0.0, p.length,
+        es::ReferenceTable::resolutionFor(ref, 0.0, p.length, 1.0e-6));
     
     while (true) {
         fr::FrenetPath pth(para, p, newSts, obj);
+        pth.setEmergencyLibrary(emergency);
+        pth.setReferenceTable(table);
         auto traj = pth.generatePath();
 
         if (traj.ok) {
@@ -123,6 +134,9 @@ int main()
             break;
         }
 
+        // stopped by the fallback
+        if (traj.emergency) break;
+
         bool exit = false;
         for (int i = 0; i < traj.global.x.size(); ++i) {
             if (hypot(goal.x - traj.global.x[i], goal.y - traj.global.y[i]) < 1.0) {
@@ -141,5 +155,50 @@ int main()
         }
     }
 
-    return 0;
+    int failures = 0;
+
+    // fallbacks started off the speed grid and above max_speed brake within their level
+    for (double v : { 7.3, para.max_speed * 1.5 }) {
+        for (double a : { -0.7, 1.3 }) {
+            for (const auto& grid : emergency->lookup(v, a)) {
+                const fr::BrakeProfile bp = emergency->startingAt(grid, v, a);
+                bool valid = fabs(bp.s_d.front() - v) < 1.0e-9 && fabs(bp.s_dd.front() - a) < 1.0e-9;
+                for (size_t i = 0; i < bp.s_d.size(); ++i) {
+                    valid = valid && bp.s_dd[i] >= -bp.decel - 1.0e-9 && bp.s_d[i] >= -1.0e-9;
+                }
+                if (!valid) {
+                    std::cerr << "emergency profile from v " << v << " a " << a << " decel " << bp.decel << " is invalid" << std::endl;
+                    ++failures;
+                }
+            }
+        }
+    }
+
+    // a wall across the road leaves the service only the emergency stop
+    {
+        es::SpiralPoint center;
+        auto wall = make_shared<ob::Constraints>();
+        wall->static_obstacles.push_back(ob::stationaryObj(obstacle(rawpoints[5], center, 20.0, 6.0)));
+
+        fr::PlannerService service(para, p);
+        service.setEmergencyLibrary(emergency);
+        service.setReferenceTable(table);
+        service.postObstacles(wall);
+        service.start();
+        service.postStatus(initSts);
+
+        fr::PlanResult res;
+        for (int i = 0; i < 10000 && res.cycle == 0; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            res = service.latest();
+        }
+        service.stop();
+
+        if (!res.traj.ok || !res.traj.emergency) {
+            std::cerr << "planner service returned no emergency trajectory in front of a wall" << std::endl;
+            ++failures;
+        }
+    }
+
+    return failures == 0 ? 0 : 1;
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+// Copyright 2023 watson.wang
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "distance_field.hpp"
+
+
+namespace ob {
+	namespace {
+		constexpr double FREE = std::numeric_limits<double>::infinity();
+
+		// squared distance transform of one row (Felzenszwalb and Huttenlocher): the lower envelope
+		// of the parabolas (q - p)^2 + f[p] over the finite sites p, in cell units
+		void transformLine(const double* f, size_t n, size_t stride, double* out, vector<size_t>& v, vector<double>& z)
+		{
+			v.clear();
+			z.clear();
+			for (size_t q = 0; q < n; ++q) {
+				const double fq = f[q * stride];
+				if (fq == FREE) continue;
+
+				double s = -FREE;
+				while (!v.empty()) {
+					const size_t p = v.back();
+					const double fp = f[p * stride];
+					s = ((fq + double(q) * q) - (fp + double(p) * p)) / (2.0 * (double(q) - p));
+					if (s > z.back()) break;
+					v.pop_back();
+					z.pop_back();
+					s = -FREE;
+				}
+				v.push_back(q);
+				z.push_back(v.size() == 1 ? -FREE : s);
+			}
+
+			if (v.empty()) {
+				for (size_t q = 0; q < n; ++q) out[q * stride] = FREE;
+				return;
+			}
+
+			size_t k = 0;
+			for (size_t q = 0; q < n; ++q) {
+				while (k + 1 < v.size() && z[k + 1] < q) ++k;
+				const double dq = double(q) - v[k];
+				out[q * stride] = dq * dq + f[v[k] * stride];
+			}
+		}
+	}
+
+	DistanceField::DistanceField(const vector<stationaryObj>& obstacles, const geo_box& area, double resolution) :
+		_x0(area.min_corner().get<0>()), _y0(area.min_corner().get<1>()), _h(resolution)
+	{
+		_cols = max<size_t>(1, static_cast<size_t>(ceil((area.max_corner().get<0>() - _x0) / _h)));
+		_rows = max<size_t>(1, static_cast<size_t>(ceil((area.max_corner().get<1>() - _y0) / _h)));
+
+		// conservative rasterization, a cell is occupied as soon as its square touches a polygon
+		vector<double> grid(_cols * _rows, FREE);
+		const geo_box grid_box(geo_point(_x0, _y0), geo_point(_x0 + _cols * _h, _y0 + _rows * _h));
+		for (const auto& sobj : obstacles) {
+			const geo_box& obox = sobj.getBox();
+			if (!boost::geometry::intersects(grid_box, obox)) continue;
+
+			const size_t c0 = static_cast<size_t>(max(0.0, floor((obox.min_corner().get<0>() - _x0) / _h)));
+			const size_t r0 = static_cast<size_t>(max(0.0, floor((obox.min_corner().get<1>() - _y0) / _h)));
+			const size_t c1 = min(_cols - 1, static_cast<size_t>(max(0.0, floor((obox.max_corner().get<0>() - _x0) / _h))));
+			const size_t r1 = min(_rows - 1, static_cast<size_t>(max(0.0, floor((obox.max_corner().get<1>() - _y0) / _h))));
+			for (size_t r = r0; r <= r1; ++r) {
+				for (size_t c = c0; c <= c1; ++c) {
+					if (grid[r * _cols + c] == 0.0) continue;
+					const geo_box cell(geo_point(_x0 + c * _h, _y0 + r * _h), geo_point(_x0 + (c + 1) * _h, _y0 + (r + 1) * _h));
+					if (boost::geometry::intersects(cell, sobj.getPoly())) grid[r * _cols + c] = 0.0;
+				}
+			}
+		}
+
+		// separable exact transform: columns, then rows of the column result
+		vector<double> columns(grid.size());
+		vector<size_t> v;
+		vector<double> z;
+		v.reserve(max(_cols, _rows));
+		z.reserve(max(_cols, _rows));
+		for (size_t c = 0; c < _cols; ++c) {
+			transformLine(grid.data() + c, _rows, _cols, columns.data() + c, v, z);
+		}
+		for (size_t r = 0; r < _rows; ++r) {
+			transformLine(columns.data() + r * _cols, _cols, 1, grid.data() + r * _cols, v, z);
+		}
+
+		_dist.resize(grid.size());
+		for (size_t i = 0; i < grid.size(); ++i) {
+			_dist[i] = static_cast<float>(sqrt(grid[i]) * _h);
+		}
+	}
+
+	bool DistanceField::contains(double x, double y, double r) const
+	{
+		return x - r >= _x0 && y - r >= _y0 && x + r <= _x0 + _cols * _h && y + r <= _y0 + _rows * _h;
+	}
+
+	double DistanceField::distance(double x, double y) const
+	{
+		const size_t c = min(_cols - 1, static_cast<size_t>(max(0.0, (x - _x0) / _h)));
+		const size_t r = min(_rows - 1, static_cast<size_t>(max(0.0, (y - _y0) / _h)));
+		return max(0.0, _dist[r * _cols + c] - maxError());
+	}
+}
@@ -0,0 +1,106 @@
+// Copyright 2023 watson.wang
+
+#include <algorithm>
+
+#include "emergency.hpp"
+
+
+namespace fr {
+	namespace {
+		// a quartic to standstill peaks at about 1.5 v / T deceleration, stretch T until the profile
+		// sampled every tick respects decel and never reverses, 0 if already stopped
+		double stopTime(double v, double a, double decel, double tick, double horizon)
+		{
+			if (!(v > 0.0)) return 0.0;
+
+			double T = max(1.5 * v / decel, tick);
+			while (true) {
+				QuarticPolynomial lon(0.0, v, a, 0.0, 0.0, T);
+				bool valid = true;
+				for (double t = 0; t < T; t += tick) {
+					if (lon.acceleration(t) < -decel - 1.0e-9 || lon.velocity(t) < -1.0e-9) {
+						valid = false;
+						break;
+					}
+				}
+				if (valid || T > horizon * 4.0) break;
+				T *= 1.1;
+			}
+			return T;
+		}
+
+		// quartic from (v, a) to standstill over stop_time sampled every tick, held after the stop
+		void sampleProfile(BrakeProfile& bp, double v, double a, double tick, double horizon)
+		{
+			bp.s.clear();
+			bp.s_d.clear();
+			bp.s_dd.clear();
+			bp.s_ddd.clear();
+
+			const double T = max(bp.stop_time, tick);
+			QuarticPolynomial lon(0.0, v, a, 0.0, 0.0, T);
+			const double s_stop = bp.stop_time > 0.0 ? lon.position(T) : 0.0;
+			for (double t = 0; t < horizon; t += tick) {
+				if (t < bp.stop_time) {
+					bp.s.push_back(lon.position(t));
+					bp.s_d.push_back(lon.velocity(t));
+					bp.s_dd.push_back(lon.acceleration(t));
+					bp.s_ddd.push_back(lon.jerk(t));
+				}
+				else {
+					bp.s.push_back(s_stop);
+					bp.s_d.push_back(0.0);
+					bp.s_dd.push_back(0.0);
+					bp.s_ddd.push_back(0.0);
+				}
+			}
+		}
+	}
+
+	EmergencyLibrary::EmergencyLibrary(const Parameters& para, double speed_step, double acc_step) :
+		_speed_step(speed_step), _acc_step(acc_step), _min_acc(-para.max_deceleration),
+		_time_tick(para.time_tick), _horizon(para.max_pred_time)
+	{
+		_num_v = static_cast<size_t>(ceil(para.max_speed / _speed_step)) + 1;
+		_num_a = static_cast<size_t>(ceil((para.max_acceration + para.max_deceleration) / _acc_step)) + 1;
+		_profiles.resize(_num_v * _num_a);
+
+		const double levels[] = { para.max_deceleration / 3.0, para.max_deceleration * 2.0 / 3.0, para.max_deceleration };
+
+		for (size_t i = 0; i < _num_v; ++i) {
+			for (size_t j = 0; j < _num_a; ++j) {
+				const double v = i * _speed_step;
+				const double a = _min_acc + j * _acc_step;
+
+				for (double decel : levels) {
+					BrakeProfile bp;
+					bp.decel = decel;
+
+					bp.stop_time = stopTime(v, a, decel, para.time_tick, para.max_pred_time);
+					sampleProfile(bp, v, a, para.time_tick, para.max_pred_time);
+
+					_profiles[i * _num_a + j].push_back(std::move(bp));
+				}
+			}
+		}
+	}
+
+	const vector<BrakeProfile>& EmergencyLibrary::lookup(double v, double a) const
+	{
+		size_t i = static_cast<size_t>(max(0.0, ceil(v / _speed_step)));
+		size_t j = static_cast<size_t>(max(0.0, round((a - _min_acc) / _acc_step)));
+		i = min(i, _num_v - 1);
+		j = min(j, _num_a - 1);
+
+		return _profiles[i * _num_a + j];
+	}
+
+	BrakeProfile EmergencyLibrary::startingAt(const BrakeProfile& bp, double v, double a) const
+	{
+		BrakeProfile ans;
+		ans.decel = bp.decel;
+		ans.stop_time = stopTime(v, a, bp.decel, _time_tick, _horizon);
+		sampleProfile(ans, v, a, _time_tick, _horizon);
+		return ans;
+	}
+}
@@ -0,0 +1,123 @@
+// Copyright 2023 watson.wang
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#include "lane/frenet_projector.hpp"
+#include "frenet_occupancy.hpp"
+
+
+namespace fr {
+	FrenetOccupancy::FrenetOccupancy(const vector<ob::stationaryObj>& obstacles, shared_ptr<const es::ReferenceTable> table,
+		double s_begin, double s_end, double ds, double radius) :
+		_s0(s_begin), _ds(ds), _bins(max<size_t>(1, static_cast<size_t>(ceil((s_end - s_begin) / ds))))
+	{
+		constexpr double INF = std::numeric_limits<double>::infinity();
+		const long reach = static_cast<long>(floor(radius / _ds)) + 1;
+		const long bins = static_cast<long>(_bins);
+
+		const es::FrenetProjector projector(std::move(table));
+		vector<vector<Interval>> blocked(_bins);
+		vector<Interval> span(_bins, { INF, -INF });
+		vector<size_t> touched;
+		vector<double> fs, fd;
+
+		for (const auto& sobj : obstacles) {
+			// outline in Frenet coordinates. The first vertex starts from s_begin, every further
+			// point from the previous one, so no search carries over from another obstacle
+			const geo_ring& ring = sobj.getPoly();
+			fs.clear();
+			fd.clear();
+			double guess = s_begin;
+			for (size_t k = 0; k + 1 < ring.size(); ++k) {
+				const double ax = ring[k].get<0>(), ay = ring[k].get<1>();
+				const double bx = ring[k + 1].get<0>(), by = ring[k + 1].get<1>();
+				const size_t n = max<size_t>(1, static_cast<size_t>(ceil(hypot(bx - ax, by - ay) / (0.5 * _ds))));
+				for (size_t j = 0; j < n; ++j) {
+					const double u = double(j) / n;
+					const es::FrenetPoint fp = projector.project(ax + u * (bx - ax), ay + u * (by - ay), guess);
+					guess = fp.s;
+					fs.push_back(fp.s);
+					fd.push_back(fp.d);
+				}
+			}
+			if (fs.empty()) continue;
+			fs.push_back(fs.front());
+			fd.push_back(fd.front());
+
+			// d span of every outline piece per bin it crosses, spread over the neighbours within reach
+			touched.clear();
+			for (size_t j = 0; j + 1 < fs.size(); ++j) {
+				double s0 = fs[j], d0 = fd[j], s1 = fs[j + 1], d1 = fd[j + 1];
+				if (s1 < s0) {
+					swap(s0, s1);
+					swap(d0, d1);
+				}
+
+				const long b0 = static_cast<long>(floor((s0 - _s0) / _ds));
+				const long b1 = static_cast<long>(floor((s1 - _s0) / _ds));
+				if (b1 + reach < 0 || b0 - reach >= bins) continue;
+
+				for (long b = b0; b <= b1; ++b) {
+					// the piece clipped to the bin
+					const double lo_s = max(s0, _s0 + b * _ds);
+					const double hi_s = min(s1, _s0 + (b + 1) * _ds);
+					const double slope = s1 > s0 ? (d1 - d0) / (s1 - s0) : 0.0;
+					const double da = d0 + slope * (lo_s - s0);
+					const double db = d0 + slope * (hi_s - s0);
+					const double lo_d = min(da, db) - radius;
+					const double hi_d = max(da, db) + radius;
+
+					for (long bb = max(0L, b - reach); bb <= min(bins - 1, b + reach); ++bb) {
+						Interval& iv = span[bb];
+						if (iv.lo > iv.hi) touched.push_back(bb);
+						iv.lo = min(iv.lo, lo_d);
+						iv.hi = max(iv.hi, hi_d);
+					}
+				}
+			}
+
+			for (size_t bb : touched) {
+				blocked[bb].push_back(span[bb]);
+				span[bb] = { INF, -INF };
+			}
+		}
+
+		_offsets.reserve(_bins + 1);
+		_offsets.push_back(0);
+		for (auto& ivs : blocked) {
+			sort(ivs.begin(), ivs.end(), [](const Interval& a, const Interval& b) { return a.lo < b.lo; });
+			for (const Interval& iv : ivs) {
+				if (_intervals.size() > _offsets.back() && iv.lo <= _intervals.back().hi) {
+					_intervals.back().hi = max(_intervals.back().hi, iv.hi);
+				}
+				else {
+					_intervals.push_back(iv);
+				}
+			}
+			_offsets.push_back(_intervals.size());
+		}
+	}
+
+	bool FrenetOccupancy::isBlocked(double s, double d) const
+	{
+		const double u = (s - _s0) / _ds;
+		if (!(u >= 0.0) || u >= _bins) return true;
+
+		const size_t b = static_cast<size_t>(u);
+		const auto first = _intervals.begin() + _offsets[b];
+		const auto last = _intervals.begin() + _offsets[b + 1];
+		auto it = upper_bound(first, last, d, [](double v, const Interval& iv) { return v < iv.lo; });
+		return it != first && d <= prev(it)->hi;
+	}
+
+	bool FrenetOccupancy::collides(const vector<double>& s, const vector<double>& d) const
+	{
+		for (size_t i = 0; i < s.size(); ++i) {
+			if (isBlocked(s[i], d[i])) return true;
+		}
+
+		return false;
+	}
+}
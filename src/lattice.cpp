@@ -7,158 +7,456 @@
 #include <Eigen/Geometry>
 
 #include "lattice.hpp"
+#include "cost.hpp"
+#include "emergency.hpp"
+#include "st_graph.hpp"
+#include "vecmath.hpp"
 
 
 namespace fr {
 	Trajectory FrenetPath::generatePath()
 	{
-		vector<Trajectory> trajs = generateTrajectories();
-		calcGlobalPaths(trajs);
-		checkPaths(trajs);
-		
-		return findOptimal(trajs);
+		return generatePath(cost::makeDefaultCost(_para));
 	}
 
-	vector<Trajectory> FrenetPath::generateTrajectories()
+	vector<FrenetPath::Candidate> FrenetPath::generateCandidates()
 	{
-		vector<Trajectory> trajs;
+		vector<Candidate> candidates;
+
+		std::optional<StGraph> graph;
+		if (_para.lon_mode == LongitudinalMode::ST_GRAPH) {
+			graph.emplace(_para, _rfl, _sts, _obj->moving_obstacles, _motion, _table);
+		}
 
 		for (double di = -_para.max_road_width; di < _para.max_road_width; di += _para.max_road_sample_width)
 		{
 			for (double ti = _para.min_pred_time; ti < _para.max_pred_time; ti += _para.time_tick)
 			{
+				double t_last = 0.0;
+				for (double t = 0; t < ti; t += _para.time_tick) {
+					t_last = t;
+				}
+
 				Trajectory tj;
 				tj.lateral_polynomial = QuinticPolynomial(_sts.d, _sts.d_d, _sts.d_dd, di, 0.0, 0.0, ti);
 
-				auto square_sum = [](vector<double> n) {
-					double ans = 0.0;
-					for (int i = 0; i < n.size(); ++i) {
-						ans += n[i] * n[i];
+				if (graph) {
+					if (!deadlineExpired() && planSpeedProfile(tj, ti, *graph)) {
+						candidates.push_back({ tj, ti, t_last, 0.0 });
 					}
-					return ans;
-				};
+					continue;
+				}
 
 				for (double tv = _para.target_speed - _para.target_speed_sample * _para.target_speed_num;
 					tv < _para.target_speed + _para.target_speed_sample * _para.target_speed_num;
 					tv += _para.target_speed_sample)
 				{
 					tj.longitudinal_polynomial = QuarticPolynomial(_sts.s, _sts.s_d, _sts.s_dd, tv, 0.0, ti);
-					for (double t = 0; t < ti; t += _para.time_tick)
-					{
-						tj.samples.d.push_back(tj.lateral_polynomial->position(t));
-						tj.samples.d_d.push_back(tj.lateral_polynomial->velocity(t));
-						tj.samples.d_dd.push_back(tj.lateral_polynomial->acceleration(t));
-						tj.samples.d_ddd.push_back(tj.lateral_polynomial->jerk(t));
-
-						tj.samples.s.push_back(tj.longitudinal_polynomial->position(t));
-						tj.samples.s_d.push_back(tj.longitudinal_polynomial->velocity(t));
-						tj.samples.s_dd.push_back(tj.longitudinal_polynomial->acceleration(t));
-						tj.samples.s_ddd.push_back(tj.longitudinal_polynomial->jerk(t));
-					}
+					candidates.push_back({ tj, ti, t_last, 0.0 });
+				}
+			}
+		}
+
+		return candidates;
+	}
+
+	void FrenetPath::sampleTrajectory(Trajectory& tj, double ti)
+	{
+		const Polynomial& lon = tj.longitudinal();
 
-					auto Jp = square_sum(tj.samples.d_ddd);
-					auto Js = square_sum(tj.samples.s_ddd);
+		tj.samples = FrenetLane{};
+		for (double t = 0; t < ti; t += _para.time_tick)
+		{
+			tj.samples.t.push_back(t);
 
-					auto dp = pow(tj.samples.d.back(), 2.0);
-					auto ds = pow(_para.target_speed - tj.samples.s_d.back(), 2.0);
+			tj.samples.d.push_back(tj.lateral_polynomial->position(t));
+			tj.samples.d_d.push_back(tj.lateral_polynomial->velocity(t));
+			tj.samples.d_dd.push_back(tj.lateral_polynomial->acceleration(t));
+			tj.samples.d_ddd.push_back(tj.lateral_polynomial->jerk(t));
 
-					tj.cd = _para.K_J * Jp + _para.K_T * ti + _para.K_D * dp;
-					tj.cv = _para.K_J * Js + _para.K_T * ti + _para.K_D * ds;
-					tj.cf = _para.K_LAT * tj.cd + _para.K_LON * tj.cv;
+			tj.samples.s.push_back(lon.position(t));
+			tj.samples.s_d.push_back(lon.velocity(t));
+			tj.samples.s_dd.push_back(lon.acceleration(t));
+			tj.samples.s_ddd.push_back(lon.jerk(t));
+		}
+	}
 
+	bool FrenetPath::planSpeedProfile(Trajectory& tj, double ti, StGraph& graph)
+	{
+		if (!graph.project(*tj.lateral_polynomial, ti)) {
+			// nothing crosses this lateral profile, keep the target speed
+			tj.longitudinal_polynomial = QuarticPolynomial(_sts.s, _sts.s_d, _sts.s_dd, _para.target_speed, 0.0, ti);
+		}
+		else {
+			vector<double> t, s;
+			if (!graph.search(t, s)) return false;
+
+			double sT = s.back();
+			double vT = (s.back() - s[s.size() - 2]) / (t.back() - t[t.size() - 2]);
+			double aT = 0.0;
 
-					trajs.push_back(tj);
+			if (t.size() > 3) {
+				// least squares t^3..t^5 coefficients through the dp profile, current state held fixed
+				Eigen::Matrix3d A = Eigen::Matrix3d::Zero();
+				Eigen::Vector3d B = Eigen::Vector3d::Zero();
+				for (size_t k = 1; k < t.size(); ++k) {
+					const double t3 = t[k] * t[k] * t[k];
+					const Eigen::Vector3d phi(t3 * t[k] * t[k], t3 * t[k], t3);
+					A += phi * phi.transpose();
+					B += phi * (s[k] - _sts.s - _sts.s_d * t[k] - 0.5 * _sts.s_dd * t[k] * t[k]);
 				}
+				const Eigen::Vector3d X = A.ldlt().solve(B);
+
+				const double T2 = ti * ti;
+				const double T3 = T2 * ti;
+				sT = X(0) * T3 * T2 + X(1) * T3 * ti + X(2) * T3 + 0.5 * _sts.s_dd * T2 + _sts.s_d * ti + _sts.s;
+				vT = 5 * X(0) * T3 * ti + 4 * X(1) * T3 + 3 * X(2) * T2 + _sts.s_dd * ti + _sts.s_d;
+				aT = 20 * X(0) * T3 + 12 * X(1) * T2 + 6 * X(2) * ti + _sts.s_dd;
 			}
+
+			tj.longitudinal_quintic_polynomial = QuinticPolynomial(_sts.s, _sts.s_d, _sts.s_dd, sT, vT, aT, ti);
+		}
+
+		sampleTrajectory(tj, ti);
+		for (size_t i = 0; i < tj.samples.s.size(); ++i) {
+			if (graph.isOccupied(tj.samples.t[i], tj.samples.s[i])) return false;
 		}
 
-		return trajs;
+		return true;
 	}
 
-	void FrenetPath::calcGlobalPaths(vector<Trajectory>& trajs)
+	void FrenetPath::calcCurvature(Trajectory& tj)
 	{
-		for (auto &tj : trajs) {
-			for (int i = 0; i < tj.samples.s.size(); ++i) {
-				es::SpiralPoint pos = es::getEndPoint(tj.samples.s[i], _rfl.dCurv, _rfl.initCurv, _para.start_x, _para.start_y, _para.start_yaw);
-				auto temp = pos.x + tj.samples.d[i] * cos(pos.t + M_PI_2);
-				tj.global.x.push_back(pos.x + tj.samples.d[i] * cos(pos.t + M_PI_2));
-				tj.global.y.push_back(pos.y + tj.samples.d[i] * sin(pos.t + M_PI_2));
-			}
+		// exact Frenet to Cartesian relations: with d' = dd/ds and d'' = d^2d/ds^2 along the reference,
+		// heading = theta_r + atan(d' / (1 - kappa_r d)) and the curvature follows from d, d', d'',
+		// kappa_r and kappa_r' without any Cartesian samples
+		const size_t n = tj.samples.s.size();
+		tj.samples.yaw.resize(n);
+		tj.samples.ds.resize(n);
+		tj.samples.c.resize(n);
 
-			for (int i = 1; i < tj.global.x.size(); ++i) {
-				double tdx = tj.global.x[i] - tj.global.x[i - 1];
-				double tdy = tj.global.y[i] - tj.global.y[i - 1];
-				tj.samples.yaw.push_back(atan2(tdy, tdx));
-				tj.samples.ds.push_back(hypot(tdy, tdx));
+		// reference state and d' per sample, then the heading offsets atan2(d', 1 - kappa_r d) and
+		// the stretch |(1 - kappa_r d, d')| as batches
+		vector<double> kr(n), dkr(n, _rfl.dCurv), tr(n), dp(n, 0.0), dpp(n, 0.0), one_minus_kd(n);
+		vector<double> angle(n), norm(n);
+		if (_table) {
+			vector<double> sin_r(n), cos_r(n);
+			for (size_t i = 0; i < n; ++i) {
+				es::ReferencePose pose = _table->lookup(tj.samples.s[i]);
+				kr[i] = pose.curv;
+				dkr[i] = pose.dCurv;
+				sin_r[i] = pose.sinT;
+				cos_r[i] = pose.cosT;
+			}
+			vecmath::atan2(sin_r.data(), cos_r.data(), n, tr.data());
+		}
+		else {
+			for (size_t i = 0; i < n; ++i) {
+				kr[i] = _ref.curvature(tj.samples.s[i]);
+				tr[i] = _ref.heading(tj.samples.s[i]);
 			}
-			tj.samples.yaw.push_back(tj.samples.yaw.back());
-			tj.samples.ds.push_back(tj.samples.ds.back());
+		}
 
-			for (int i = 1; i < tj.samples.yaw.size(); ++i) {
-				tj.samples.c.push_back(tj.samples.yaw[i] - tj.samples.yaw[i - 1]);
+		for (size_t i = 0; i < n; ++i) {
+			// a stationary sample keeps the reference heading
+			const double s_d = tj.samples.s_d[i];
+			if (abs(s_d) > 1.0e-3) {
+				dp[i] = tj.samples.d_d[i] / s_d;
+				dpp[i] = (tj.samples.d_dd[i] - dp[i] * tj.samples.s_dd[i]) / (s_d * s_d);
 			}
+			one_minus_kd[i] = 1.0 - kr[i] * tj.samples.d[i];
+		}
+		vecmath::atan2(dp.data(), one_minus_kd.data(), n, angle.data());
+		vecmath::hypot(one_minus_kd.data(), dp.data(), n, norm.data());
+
+		for (size_t i = 0; i < n; ++i) {
+			const double cos_dt = one_minus_kd[i] / norm[i];
+			const double tan_dt = dp[i] / one_minus_kd[i];
+
+			tj.samples.yaw[i] = tr[i] + angle[i];
+			tj.samples.ds[i] = abs(tj.samples.s_d[i]) * norm[i] * _para.time_tick;
+			tj.samples.c[i] = ((dpp[i] + (dkr[i] * tj.samples.d[i] + kr[i] * dp[i]) * tan_dt) * cos_dt * cos_dt / one_minus_kd[i] + kr[i]) *
+				cos_dt / one_minus_kd[i];
+		}
+	}
+
+	bool FrenetPath::checkKinematics(Trajectory& tj)
+	{
+		if (find_if(tj.samples.s_d.begin(), tj.samples.s_d.end(), [this](double isd) {
+			return isd > _para.max_speed;
+			}) != tj.samples.s_d.end()) {
+			return false;
+		}
+
+		if (find_if(tj.samples.s_dd.begin(), tj.samples.s_dd.end(), [this](double isdd) {
+			return isdd > _para.max_acceration;
+			}) != tj.samples.s_dd.end()) {
+			return false;
+		}
+
+		calcCurvature(tj);
+		if (find_if(tj.samples.c.begin(), tj.samples.c.end(), [this](double ic) {
+			return abs(ic) > _para.max_curvature;
+			}) != tj.samples.c.end()) {
+			return false;
+		}
+
+		return true;
+	}
+
+	void FrenetPath::calcGlobalPath(Trajectory& tj)
+	{
+		vector<double> cos_t, sin_t;
+		if (_table) {
+			_table->lookup(tj.samples.s, tj.global.x, tj.global.y, cos_t, sin_t);
+		}
+		else if (_para.spiral_resync_interval > 0) {
+			// samples advance by a few centimeters per tick, step along the spiral instead of
+			// evaluating the Fresnel integrals at every one of them
+			es::SpiralWalker walker(_ref, _para.spiral_resync_interval);
+			walker.walk(tj.samples.s, tj.global.x, tj.global.y, cos_t, sin_t);
+		}
+		else {
+			vector<double> theta;
+			_ref.evaluate(tj.samples.s, tj.global.x, tj.global.y, theta);
+			cos_t.resize(theta.size());
+			sin_t.resize(theta.size());
+			vecmath::sincos(theta.data(), theta.size(), sin_t.data(), cos_t.data());
+		}
+
+		for (size_t i = 0; i < tj.samples.s.size(); ++i) {
+			tj.global.x[i] -= tj.samples.d[i] * sin_t[i];
+			tj.global.y[i] += tj.samples.d[i] * cos_t[i];
 		}
 	}
 
 	bool FrenetPath::isCollision(Trajectory & traj)
 	{
-		for (auto sobj : _obj->static_obstacles) {
-			for (int i = 0; i < traj.global.x.size(); ++i) {
-				geo_point gp_in(traj.global.x[i], traj.global.y[i]);
-				if (boost::geometry::within(gp_in, sobj.getPoly())) return true;
+		if (traj.global.x.empty()) return false;
+
+		if (_para.collision_mode == CollisionMode::POINT) {
+			// broad phase on the R-tree per piece of trajectory, point in polygon only for points
+			// inside an obstacle box
+			return _index->collides(_obj->static_obstacles, traj.global.x, traj.global.y) ||
+				isMovingCollision(traj);
+		}
+
+		vector<double> offsets;
+		const double r = footprint(offsets);
+		const size_t n = traj.global.x.size();
+		vector<double> sin_y(n, 0.0), cos_y(n, 1.0);
+		if (offsets.size() > 1) {
+			vecmath::sincos(traj.samples.yaw.data(), n, sin_y.data(), cos_y.data());
+		}
+
+		// one lookup per disk, disks reaching out of the grid take the exact polygon distance
+		for (size_t i = 0; i < n; ++i) {
+			for (double off : offsets) {
+				const double x = traj.global.x[i] + off * cos_y[i];
+				const double y = traj.global.y[i] + off * sin_y[i];
+				if (_field && _field->contains(x, y, r)) {
+					if (_field->distance(x, y) < r) return true;
+				}
+				else if (_index->near(_obj->static_obstacles, x, y, r)) {
+					return true;
+				}
 			}
 		}
 
-		return false;
+		return isMovingCollision(traj);
 	}
 
-	void FrenetPath::checkPaths(vector<Trajectory>& trajs)
+	bool FrenetPath::isMovingCollision(const Trajectory& traj)
 	{
-		for (auto &tj : trajs) {
-			if (find_if(tj.samples.s_d.begin(), tj.samples.s_d.end(), [this](double isd) {
-				return isd > _para.max_speed;
-				}) != tj.samples.s_d.end()) {
-				continue;
-			}
+		if (!_motion) return false;
 
-			if (find_if(tj.samples.s_dd.begin(), tj.samples.s_dd.end(), [this](double isdd) {
-				return isdd > _para.max_acceration;
-				}) != tj.samples.s_dd.end()) {
-				continue;
-			}
+		vector<double> offsets;
+		const double r = footprint(offsets);
+		const size_t n = traj.global.x.size();
+		vector<double> sin_y(n, 0.0), cos_y(n, 1.0);
+		if (offsets.size() > 1) {
+			vecmath::sincos(traj.samples.yaw.data(), n, sin_y.data(), cos_y.data());
+		}
 
-			if (find_if(tj.samples.c.begin(), tj.samples.c.end(), [this](double ic) {
-				return ic > _para.max_curvature;
-				}) != tj.samples.c.end()) {
-				continue;
+		// every sample only meets the slice of its own time
+		for (size_t i = 0; i < n; ++i) {
+			for (double off : offsets) {
+				const double x = traj.global.x[i] + off * cos_y[i];
+				const double y = traj.global.y[i] + off * sin_y[i];
+				if (_motion->collides(traj.samples.t[i], x, y, r)) return true;
 			}
+		}
+
+		return false;
+	}
+
+	void FrenetPath::buildDistanceField()
+	{
+		double x, y, cos_t, sin_t;
+		if (_table) {
+			const es::ReferencePose pose = _table->lookup(_sts.s);
+			x = pose.x;
+			y = pose.y;
+			cos_t = pose.cosT;
+			sin_t = pose.sinT;
+		}
+		else {
+			const es::SpiralPoint pose = _ref.evaluate(_sts.s);
+			x = pose.x;
+			y = pose.y;
+			cos_t = cos(pose.t);
+			sin_t = sin(pose.t);
+		}
+		x -= _sts.d * sin_t;
+		y += _sts.d * cos_t;
+
+		// trajectories run ahead, so the grid reaches from extent / 2 behind to 3 extent / 2 ahead of the ego
+		const double e = _para.distance_field_extent;
+		const double cx = x + 0.5 * e * cos_t;
+		const double cy = y + 0.5 * e * sin_t;
+		_field.emplace(_obj->static_obstacles, geo_box(geo_point(cx - e, cy - e), geo_point(cx + e, cy + e)),
+			_para.distance_field_resolution);
+	}
 
-			if (isCollision(tj)) {
-				continue;
+	void FrenetPath::buildOccupancy()
+	{
+		// everything a feasible candidate can reach, a disk behind the ego included
+		const double reach = _para.max_speed * _para.max_pred_time;
+		_occupancy.emplace(_obj->static_obstacles, _table, _sts.s - _para.radius - _para.frenet_s_resolution,
+			_sts.s + reach + _para.radius + _para.frenet_s_resolution, _para.frenet_s_resolution, _para.radius);
+	}
+
+	void FrenetPath::buildMotionSlices()
+	{
+		const size_t slices = static_cast<size_t>(ceil(_para.max_pred_time / _para.time_tick)) + 1;
+		_motion = make_shared<const ob::MotionSlices>(_obj->moving_obstacles, _para.time_tick, slices);
+	}
+
+	double FrenetPath::footprint(vector<double>& offsets) const
+	{
+		offsets.assign(1, 0.0);
+		switch (_para.collision_mode) {
+		case CollisionMode::RADIUS:
+		case CollisionMode::FRENET:
+			return _para.radius;
+		case CollisionMode::FOOTPRINT: {
+			// equal disks centered along the heading, each covering a vehicle_length / n slice
+			const size_t n = max<size_t>(1, _para.footprint_circles);
+			const double half = 0.5 * _para.vehicle_length / n;
+			offsets.resize(n);
+			for (size_t k = 0; k < n; ++k) {
+				offsets[k] = -0.5 * _para.vehicle_length + half * (2 * k + 1);
 			}
+			return hypot(half, 0.5 * _para.vehicle_width);
+		}
+		default:
+			return 0.0;
+		}
+	}
 
-			tj.ok = true;
+	void FrenetPath::checkPath(Trajectory& tj)
+	{
+		if (_occupancy) {
+			tj.ok = !_occupancy->collides(tj.samples.s, tj.samples.d);
+			// moving obstacles are only known in Cartesian space
+			if (tj.ok && _motion) {
+				calcGlobalPath(tj);
+				tj.ok = !isMovingCollision(tj);
+			}
+			return;
 		}
+
+		calcGlobalPath(tj);
+		tj.ok = !isCollision(tj);
+	}
+
+	bool FrenetPath::overlapsObstacles(const Trajectory& tj)
+	{
+		if (tj.global.x.empty()) return false;
+
+		// grown by the reach of the footprint disks
+		vector<double> offsets;
+		const double reach = footprint(offsets) + abs(offsets.back());
+		geo_box box = trajectoryBox(tj);
+		box.min_corner().set<0>(box.min_corner().get<0>() - reach);
+		box.min_corner().set<1>(box.min_corner().get<1>() - reach);
+		box.max_corner().set<0>(box.max_corner().get<0>() + reach);
+		box.max_corner().set<1>(box.max_corner().get<1>() + reach);
+		return _index->intersects(box) || (_motion && _motion->intersects(box));
 	}
 
-	Trajectory FrenetPath::findOptimal(vector<Trajectory>& trajs)
+	geo_box FrenetPath::trajectoryBox(const Trajectory& tj)
 	{
-		Trajectory path;
-		double min_cf = DBL_MAX;
-		for (auto &tj : trajs) {
-			if (tj.ok) {
-				if (tj.cf < min_cf) {
-					min_cf = tj.cf;
-					path = tj;
+		auto [xmin, xmax] = minmax_element(tj.global.x.begin(), tj.global.x.end());
+		auto [ymin, ymax] = minmax_element(tj.global.y.begin(), tj.global.y.end());
+		return geo_box(geo_point(*xmin, *ymin), geo_point(*xmax, *ymax));
+	}
+
+	Trajectory FrenetPath::emergencyPath()
+	{
+		const vector<BrakeProfile>& profiles = _emergency->lookup(_sts.s_d, _sts.s_dd);
+
+		Trajectory hardest;
+		for (auto& grid : profiles) {
+			// the grid profile starts at the rounded speed, continue from the actual state instead
+			const BrakeProfile bp = _emergency->startingAt(grid, _sts.s_d, _sts.s_dd);
+			// hold the current offset first, then stop on the reference line
+			for (double target : { _sts.d, 0.0 }) {
+				Trajectory tj;
+				tj.emergency = true;
+				const double T = max(bp.stop_time, _para.time_tick);
+				tj.lateral_polynomial = QuinticPolynomial(_sts.d, _sts.d_d, _sts.d_dd, target, 0.0, 0.0, T);
+
+				tj.samples.s = bp.s;
+				tj.samples.s_d = bp.s_d;
+				tj.samples.s_dd = bp.s_dd;
+				tj.samples.s_ddd = bp.s_ddd;
+				for (size_t i = 0; i < bp.s.size(); ++i) {
+					const double t = i * _para.time_tick;
+					const bool moving = t < T;
+					tj.samples.t.push_back(t);
+					tj.samples.s[i] += _sts.s;
+					tj.samples.d.push_back(tj.lateral_polynomial->position(min(t, T)));
+					tj.samples.d_d.push_back(moving ? tj.lateral_polynomial->velocity(t) : 0.0);
+					tj.samples.d_dd.push_back(moving ? tj.lateral_polynomial->acceleration(t) : 0.0);
+					tj.samples.d_ddd.push_back(moving ? tj.lateral_polynomial->jerk(t) : 0.0);
 				}
+
+				calcCurvature(tj);
+				calcGlobalPath(tj);
+
+				// exact checks only if the bounding boxes touch an obstacle
+				tj.ok = find_if(tj.samples.c.begin(), tj.samples.c.end(), [this](double ic) {
+					return abs(ic) > _para.max_curvature;
+					}) == tj.samples.c.end();
+				tj.ok = tj.ok && (!overlapsObstacles(tj) || !isCollision(tj));
+				if (tj.ok) return tj;
+
+				hardest = std::move(tj);
 			}
 		}
 
-		return path;
+		return hardest;
+	}
+
+	bool FrenetPath::deadlineExpired() const
+	{
+		if (_para.plan_deadline <= 0.0) return false;
+		return std::chrono::duration<double>(std::chrono::steady_clock::now() - _start).count() > _para.plan_deadline;
 	}
 
 	void FrenetPath::setStatus(Status sts)
 	{
 		_sts = sts;
 	}
+
+	void FrenetPath::setEmergencyLibrary(shared_ptr<const EmergencyLibrary> lib)
+	{
+		_emergency = std::move(lib);
+	}
+
+	void FrenetPath::setReferenceTable(shared_ptr<const es::ReferenceTable> table)
+	{
+		_table = std::move(table);
+	}
 }
\ No newline at end of file
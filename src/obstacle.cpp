@@ -1,4 +1,185 @@
 // Copyright 2023 watson.wang
 
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
 #include "obstacle.hpp"
 
+namespace ob {
+	PredictedPose movingObj::pose(double t) const
+	{
+		if (!_path.empty()) {
+			if (t <= _path.front().t) return _path.front();
+			if (t >= _path.back().t) return _path.back();
+
+			auto hi = upper_bound(_path.begin(), _path.end(), t, [](double v, const PredictedPose& p) { return v < p.t; });
+			auto lo = prev(hi);
+			const double u = (t - lo->t) / (hi->t - lo->t);
+			return { t, lo->x + u * (hi->x - lo->x), lo->y + u * (hi->y - lo->y), lo->yaw + u * (hi->yaw - lo->yaw) };
+		}
+
+		const double yaw = _yaw_rate * t;
+		if (abs(yaw) < 1.0e-9) return { t, _vx * t, _vy * t, 0.0 };
+
+		// the velocity turns with the footprint, integrated in closed form
+		const double s = sin(yaw), c = 1.0 - cos(yaw);
+		return { t, (_vx * s - _vy * c) / _yaw_rate, (_vy * s + _vx * c) / _yaw_rate, yaw };
+	}
+
+	geo_ring movingObj::predict(double t) const
+	{
+		const PredictedPose p = pose(t);
+		const double s = sin(p.yaw), c = cos(p.yaw);
+		const double cx = _center.get<0>(), cy = _center.get<1>();
+
+		geo_ring ans;
+		ans.reserve(_poly.size());
+		for (const geo_point& v : _poly) {
+			const double dx = v.get<0>() - cx, dy = v.get<1>() - cy;
+			ans.push_back(geo_point(cx + c * dx - s * dy + p.x, cy + s * dx + c * dy + p.y));
+		}
+
+		return ans;
+	}
+
+	ObstacleIndex::ObstacleIndex(const vector<stationaryObj>& obstacles)
+	{
+		vector<Entry> entries;
+		entries.reserve(obstacles.size());
+		_boxes.reserve(obstacles.size());
+		for (size_t i = 0; i < obstacles.size(); ++i) {
+			entries.emplace_back(obstacles[i].getBox(), i);
+			_boxes.push_back(obstacles[i].getBox());
+		}
+		// the range constructor packs the tree in one pass
+		_tree = decltype(_tree)(entries.begin(), entries.end());
+	}
+
+	bool ObstacleIndex::matches(const vector<stationaryObj>& obstacles) const
+	{
+		if (obstacles.size() != _boxes.size()) return false;
+		for (size_t i = 0; i < obstacles.size(); ++i) {
+			if (!boost::geometry::equals(obstacles[i].getBox(), _boxes[i])) return false;
+		}
+
+		return true;
+	}
+
+	bool ObstacleIndex::intersects(const geo_box& box) const
+	{
+		return _tree.qbegin(boost::geometry::index::intersects(box)) != _tree.qend();
+	}
+
+	bool ObstacleIndex::collides(const vector<stationaryObj>& obstacles, const vector<double>& x, const vector<double>& y) const
+	{
+		vector<Entry> hits;
+		for (size_t begin = 0; begin < x.size(); begin += SEGMENT) {
+			const size_t end = min(x.size(), begin + SEGMENT);
+			auto [xmin, xmax] = minmax_element(x.begin() + begin, x.begin() + end);
+			auto [ymin, ymax] = minmax_element(y.begin() + begin, y.begin() + end);
+
+			hits.clear();
+			_tree.query(boost::geometry::index::intersects(geo_box(geo_point(*xmin, *ymin), geo_point(*xmax, *ymax))), back_inserter(hits));
+			for (const Entry& hit : hits) {
+				const geo_box& obox = hit.first;
+				for (size_t i = begin; i < end; ++i) {
+					if (x[i] < obox.min_corner().get<0>() || x[i] > obox.max_corner().get<0>() ||
+						y[i] < obox.min_corner().get<1>() || y[i] > obox.max_corner().get<1>()) continue;
+					if (boost::geometry::within(geo_point(x[i], y[i]), obstacles[hit.second].getPoly())) return true;
+				}
+			}
+		}
+
+		return false;
+	}
+
+	bool ObstacleIndex::near(const vector<stationaryObj>& obstacles, double x, double y, double r) const
+	{
+		const geo_point p(x, y);
+		const geo_box disk(geo_point(x - r, y - r), geo_point(x + r, y + r));
+		for (auto it = _tree.qbegin(boost::geometry::index::intersects(disk)); it != _tree.qend(); ++it) {
+			if (boost::geometry::distance(p, obstacles[it->second].getPoly()) < r) return true;
+		}
+
+		return false;
+	}
+
+	MotionSlices::MotionSlices(const vector<movingObj>& movers, double tick, size_t slices) :
+		_tick(tick), _slices(slices), _movers(movers.size())
+	{
+		_footprints.reserve(_slices * _movers);
+		_swept.reserve(_slices * _movers);
+		_bounds.reserve(_slices);
+		for (size_t k = 0; k < _slices; ++k) {
+			const double t = k * _tick;
+			geo_box bounds;
+			boost::geometry::assign_inverse(bounds);
+			for (const auto& mv : movers) {
+				_footprints.push_back(mv.predict(t));
+
+				geo_box swept = boost::geometry::return_envelope<geo_box>(_footprints.back());
+				geo_ring last;
+				double step = 0.0;
+				for (int j = 0; j <= SWEEP_STEPS; ++j) {
+					const double tj = t + _tick * (double(j) / SWEEP_STEPS - 0.5);
+					geo_ring fp = mv.predict(tj);
+					boost::geometry::expand(swept, boost::geometry::return_envelope<geo_box>(fp));
+					for (size_t v = 0; v < last.size(); ++v) {
+						step = max(step, boost::geometry::distance(last[v], fp[v]));
+					}
+					last = std::move(fp);
+				}
+				// a vertex strays at most half its step from the chord between sub-steps
+				swept.min_corner().set<0>(swept.min_corner().get<0>() - 0.5 * step);
+				swept.min_corner().set<1>(swept.min_corner().get<1>() - 0.5 * step);
+				swept.max_corner().set<0>(swept.max_corner().get<0>() + 0.5 * step);
+				swept.max_corner().set<1>(swept.max_corner().get<1>() + 0.5 * step);
+				boost::geometry::expand(bounds, swept);
+				_swept.push_back(swept);
+			}
+			_bounds.push_back(bounds);
+		}
+	}
+
+	size_t MotionSlices::sliceOf(double t) const
+	{
+		const double k = round(t / _tick);
+		return static_cast<size_t>(max(0.0, min(k, _slices - 1.0)));
+	}
+
+	bool MotionSlices::intersects(const geo_box& box) const
+	{
+		for (size_t k = 0; k < _slices; ++k) {
+			if (!boost::geometry::intersects(box, _bounds[k])) continue;
+			for (size_t m = 0; m < _movers; ++m) {
+				if (boost::geometry::intersects(box, _swept[k * _movers + m])) return true;
+			}
+		}
+
+		return false;
+	}
+
+	bool MotionSlices::collides(double t, double x, double y, double r) const
+	{
+		if (_slices == 0 || _movers == 0) return false;
+
+		auto outside = [x, y, r](const geo_box& b) {
+			return x + r < b.min_corner().get<0>() || x - r > b.max_corner().get<0>() ||
+				y + r < b.min_corner().get<1>() || y - r > b.max_corner().get<1>();
+		};
+
+		const size_t k = sliceOf(t);
+		if (outside(_bounds[k])) return false;
+
+		const geo_point p(x, y);
+		for (size_t m = 0; m < _movers; ++m) {
+			if (outside(_swept[k * _movers + m])) continue;
+
+			const geo_ring& fp = _footprints[k * _movers + m];
+			if (r > 0.0 ? boost::geometry::distance(p, fp) < r : boost::geometry::within(p, fp)) return true;
+		}
+
+		return false;
+	}
+}
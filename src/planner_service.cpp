@@ -0,0 +1,91 @@
+// Copyright 2023 watson.wang
+
+#include <chrono>
+
+#include "planner_service.hpp"
+
+
+namespace fr {
+	PlannerService::PlannerService(Parameters para, es::SpiralParameter rfl) :
+		_para(para), _rfl(rfl)
+	{
+	}
+
+	PlannerService::~PlannerService()
+	{
+		stop();
+	}
+
+	void PlannerService::setEmergencyLibrary(shared_ptr<const EmergencyLibrary> emergency)
+	{
+		_emergency = std::move(emergency);
+	}
+
+	void PlannerService::setReferenceTable(shared_ptr<const es::ReferenceTable> table)
+	{
+		_table = std::move(table);
+	}
+
+	void PlannerService::start()
+	{
+		if (_running.exchange(true)) return;
+		_worker = thread(&PlannerService::run, this);
+	}
+
+	void PlannerService::stop()
+	{
+		if (!_running.exchange(false)) return;
+		_wake.notify_one();
+		_worker.join();
+	}
+
+	void PlannerService::postStatus(const Status& sts)
+	{
+		_status.post(sts);
+		_wake.notify_one();
+	}
+
+	void PlannerService::postObstacles(shared_ptr<ob::Constraints> obj)
+	{
+		if (obj && !obj->indexed()) obj->buildIndex();
+		_obstacles.post(std::move(obj));
+	}
+
+	const PlanResult& PlannerService::latest()
+	{
+		_result.fetch();
+		return _result.front();
+	}
+
+	void PlannerService::run()
+	{
+		shared_ptr<const ob::Constraints> obj = make_shared<const ob::Constraints>();
+		uint64_t cycle = 0;
+
+		while (_running.load()) {
+			if (!_status.fetch()) {
+				// the producer notifies without the lock, the timeout covers a missed wake up
+				unique_lock<mutex> lock(_wake_mtx);
+				_wake.wait_for(lock, chrono::milliseconds(1), [this] {
+					return !_running.load() || _status.fresh();
+					});
+				continue;
+			}
+
+			if (_obstacles.fetch() && _obstacles.front()) {
+				obj = _obstacles.front();
+			}
+
+			const Status sts = _status.front();
+			FrenetPath pth(_para, _rfl, sts, obj);
+			pth.setEmergencyLibrary(_emergency);
+			pth.setReferenceTable(_table);
+
+			PlanResult& res = _result.back();
+			res.traj = pth.generatePath();
+			res.input = sts;
+			res.cycle = ++cycle;
+			_result.publish();
+		}
+	}
+}
@@ -0,0 +1,171 @@
+// Copyright 2023 watson.wang
+
+#include <corecrt_math_defines.h>
+#include <algorithm>
+#include <cfloat>
+
+#include "st_graph.hpp"
+#include "vecmath.hpp"
+
+
+namespace fr {
+	StGraph::StGraph(const Parameters& para, const es::SpiralParameter& rfl, const Status& sts,
+		const vector<ob::movingObj>& movers, shared_ptr<const ob::MotionSlices> slices,
+		shared_ptr<const es::ReferenceTable> table) :
+		_para(para), _sts(sts), _movers(movers), _slices(std::move(slices))
+	{
+		_ds = _para.st_s_resolution;
+		_num_s = static_cast<size_t>(_para.max_speed * _para.max_pred_time / _ds) + 2;
+
+		vector<double> s(_num_s);
+		for (size_t j = 0; j < _num_s; ++j) {
+			s[j] = _sts.s + j * _ds;
+		}
+
+		// left normal (cos(theta + pi/2), sin(theta + pi/2)) = (-sin(theta), cos(theta))
+		if (table) {
+			// the same line the candidates are sampled on
+			vector<double> cos_t;
+			table->lookup(s, _ref_x, _ref_y, cos_t, _ref_nx);
+			_ref_ny = std::move(cos_t);
+		}
+		else {
+			vector<double> theta;
+			es::PreparedSpiral(rfl, _para.start_x, _para.start_y, _para.start_yaw, _para.fresnel_precision).evaluate(s, _ref_x, _ref_y, theta);
+			_ref_nx.resize(_num_s);
+			_ref_ny.resize(_num_s);
+			vecmath::sincos(theta.data(), _num_s, _ref_nx.data(), _ref_ny.data());
+		}
+		for (size_t j = 0; j < _num_s; ++j) {
+			_ref_nx[j] = -_ref_nx[j];
+		}
+	}
+
+	bool StGraph::project(const QuinticPolynomial& lat, double T)
+	{
+		size_t steps = max<size_t>(1, static_cast<size_t>(round(T / _para.st_t_resolution)));
+		_dt = T / steps;
+		_rows = steps + 1;
+		_occupied.assign(_rows * _num_s, 0);
+
+		bool any = false;
+		for (size_t k = 0; k < _rows; ++k) {
+			double t = k * _dt;
+			double d = lat.position(t);
+
+			// ego corridor of this row for the swept box broad phase
+			const bool sliced = _slices && _slices->movers() == _movers.size() && _slices->covers(t);
+			geo_box corridor;
+			if (sliced) {
+				boost::geometry::assign_inverse(corridor);
+				for (size_t j = 0; j < _num_s; ++j) {
+					boost::geometry::expand(corridor, geo_point(_ref_x[j] + d * _ref_nx[j], _ref_y[j] + d * _ref_ny[j]));
+				}
+			}
+
+			for (size_t m = 0; m < _movers.size(); ++m) {
+				if (sliced && !boost::geometry::intersects(corridor, _slices->sweptBox(_slices->sliceOf(t), m))) continue;
+
+				geo_ring poly = _movers[m].predict(t);
+				geo_box box;
+				boost::geometry::envelope(poly, box);
+
+				for (size_t j = 0; j < _num_s; ++j) {
+					double x = _ref_x[j] + d * _ref_nx[j];
+					double y = _ref_y[j] + d * _ref_ny[j];
+					if (x < box.min_corner().get<0>() || x > box.max_corner().get<0>() ||
+						y < box.min_corner().get<1>() || y > box.max_corner().get<1>()) {
+						continue;
+					}
+
+					if (boost::geometry::within(geo_point(x, y), poly)) {
+						_occupied[k * _num_s + j] = 1;
+						any = true;
+					}
+				}
+			}
+		}
+
+		return any;
+	}
+
+	bool StGraph::search(vector<double>& t, vector<double>& s) const
+	{
+		if (_rows == 0 || _occupied[0]) return false;
+
+		const size_t reach = static_cast<size_t>(ceil(_para.max_speed * _dt / _ds));
+
+		// keep the vehicle radius between the profile and the occupied cells, the fitted
+		// polynomial does not follow the profile exactly
+		const size_t margin = static_cast<size_t>(ceil(_para.radius / _ds));
+		vector<char> blocked(_occupied);
+		for (size_t k = 0; k < _rows; ++k) {
+			for (size_t j = 0; j < _num_s; ++j) {
+				if (!_occupied[k * _num_s + j]) continue;
+				size_t lo = j > margin ? j - margin : 0;
+				size_t hi = min(j + margin, _num_s - 1);
+				fill(blocked.begin() + k * _num_s + lo, blocked.begin() + k * _num_s + hi + 1, 1);
+			}
+		}
+
+		vector<double> cost(_rows * _num_s, DBL_MAX);
+		vector<double> speed(_rows * _num_s, 0.0);
+		vector<size_t> parent(_rows * _num_s, 0);
+
+		cost[0] = 0.0;
+		speed[0] = _sts.s_d;
+
+		for (size_t k = 1; k < _rows; ++k) {
+			for (size_t j = 0; j < _num_s; ++j) {
+				size_t node = k * _num_s + j;
+				if (blocked[node]) continue;
+
+				for (size_t i = j > reach ? j - reach : 0; i <= j; ++i) {
+					size_t prev = (k - 1) * _num_s + i;
+					if (cost[prev] == DBL_MAX) continue;
+
+					double v = (j - i) * _ds / _dt;
+					if (v > _para.max_speed) continue;
+					double a = (v - speed[prev]) / _dt;
+					if (abs(a) > _para.max_acceration) continue;
+
+					double c = cost[prev] + (_para.K_D * pow(_para.target_speed - v, 2.0) + _para.K_J * a * a) * _dt;
+					if (c < cost[node]) {
+						cost[node] = c;
+						speed[node] = v;
+						parent[node] = i;
+					}
+				}
+			}
+		}
+
+		const size_t last = (_rows - 1) * _num_s;
+		auto best = min_element(cost.begin() + last, cost.end()) - cost.begin();
+		if (cost[best] == DBL_MAX) return false;
+
+		t.resize(_rows);
+		s.resize(_rows);
+		size_t j = best - last;
+		for (size_t k = _rows; k-- > 0;) {
+			t[k] = k * _dt;
+			s[k] = _sts.s + j * _ds;
+			j = parent[k * _num_s + j];
+		}
+
+		return true;
+	}
+
+	bool StGraph::isOccupied(double t, double s) const
+	{
+		if (_rows == 0 || t < 0.0 || s < _sts.s) return false;
+
+		size_t k0 = min(static_cast<size_t>(t / _dt), _rows - 1);
+		size_t k1 = min(k0 + 1, _rows - 1);
+		size_t j0 = static_cast<size_t>((s - _sts.s) / _ds);
+		if (j0 >= _num_s) return false;
+		size_t j1 = min(j0 + 1, _num_s - 1);
+
+		return _occupied[k0 * _num_s + j0] || _occupied[k0 * _num_s + j1] ||
+			_occupied[k1 * _num_s + j0] || _occupied[k1 * _num_s + j1];
+	}
+}
@@ -0,0 +1,205 @@
+// Copyright 2023 watson.wang
+
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__) && (defined(__FMA__) || defined(_MSC_VER))
+#include <immintrin.h>
+#define FR_VECMATH_AVX2
+#endif
+
+#include "vecmath.hpp"
+
+
+namespace fr {
+	namespace vecmath {
+		namespace {
+			// pi / 2 in three parts, the first two with trailing zero bits so q * PIO2_1 and
+			// q * PIO2_2 are exact (cephes DP1..DP3 doubled)
+			constexpr double PIO2_1 = 1.57079625129699707031e+0;
+			constexpr double PIO2_2 = 7.54978941586159635336e-8;
+			constexpr double PIO2_3 = 5.39030285815811905290e-15;
+			constexpr double TWO_O_PI = 6.36619772367581382433e-1;
+
+			// sin(r) = r + r z S(z), cos(r) = 1 - z / 2 + z^2 C(z), z = r^2, |r| <= pi / 4
+			constexpr double SIN_COEF[] = { 1.58962301576546568060e-10, -2.50507477628578072866e-8, 2.75573136213857245213e-6,
+				-1.98412698295895385996e-4, 8.33333333332211858878e-3, -1.66666666666666307295e-1 };
+			constexpr double COS_COEF[] = { -1.13585365213876817300e-11, 2.08757008419747316778e-9, -2.75573141792967388112e-7,
+				2.48015872888517045348e-5, -1.38888888888730564116e-3, 4.16666666666665929218e-2 };
+
+			// atan(t) = t + t z P(z) / Q(z), z = t^2, 0 <= t <= 0.66 (Q is monic)
+			constexpr double ATAN_P[] = { -8.750608600031904122785e-1, -1.615753718733365076637e+1, -7.500855792314704667340e+1,
+				-1.228866684490136173410e+2, -6.485021904942025371773e+1 };
+			constexpr double ATAN_Q[] = { 2.485846490142306297962e+1, 1.650270098316988542046e+2, 4.328810604912902668951e+2,
+				4.853903996359136964868e+2, 1.945506571482613964425e+2 };
+			constexpr double PIO4 = 7.85398163397448309616e-1;
+			constexpr double PIO2_HI = 1.57079632679489655800e+0;
+			constexpr double PIO2_LO = 6.12323399573676603587e-17;
+			constexpr double PI_HI = 3.14159265358979311600e+0;
+			constexpr double PI_LO = 1.22464679914735317723e-16;
+
+			void sincosScalar(double x, double& s, double& c)
+			{
+				if (std::abs(x) > SINCOS_MAX_ARG) {
+					s = std::sin(x);
+					c = std::cos(x);
+					return;
+				}
+
+				const double q = std::nearbyint(x * TWO_O_PI);
+				const double r = ((x - q * PIO2_1) - q * PIO2_2) - q * PIO2_3;
+				const double z = r * r;
+
+				double sp = SIN_COEF[0], cp = COS_COEF[0];
+				for (int k = 1; k < 6; ++k) {
+					sp = sp * z + SIN_COEF[k];
+					cp = cp * z + COS_COEF[k];
+				}
+				const double sr = r + r * z * sp;
+				const double cr = 1.0 - 0.5 * z + z * z * cp;
+
+				const int64_t quadrant = static_cast<int64_t>(q) & 3;
+				const double sv = (quadrant & 1) ? cr : sr;
+				const double cv = (quadrant & 1) ? sr : cr;
+				s = (quadrant & 2) ? -sv : sv;
+				c = ((quadrant + 1) & 2) ? -cv : cv;
+			}
+
+			double atan2Scalar(double y, double x)
+			{
+				const double ax = std::abs(x), ay = std::abs(y);
+				const double hi = ax > ay ? ax : ay;
+				const double lo = ax > ay ? ay : ax;
+				const double a = hi > 0.0 ? lo / hi : 0.0;
+
+				const bool big = a > 0.66;
+				const double t = big ? (a - 1.0) / (a + 1.0) : a;
+				const double z = t * t;
+				double p = ATAN_P[0], qq = z + ATAN_Q[0];
+				for (int k = 1; k < 5; ++k) {
+					p = p * z + ATAN_P[k];
+					qq = qq * z + ATAN_Q[k];
+				}
+				double r = t + t * z * p / qq;
+				if (big) r = PIO4 + (r + 0.5 * PIO2_LO);
+
+				if (ay > ax) r = (PIO2_HI - r) + PIO2_LO;
+				if (std::signbit(x)) r = (PI_HI - r) + PI_LO;
+				return std::signbit(y) ? -r : r;
+			}
+
+#ifdef FR_VECMATH_AVX2
+			inline __m256d polynomial(__m256d z, const double* coef, int count)
+			{
+				__m256d p = _mm256_set1_pd(coef[0]);
+				for (int k = 1; k < count; ++k) p = _mm256_fmadd_pd(p, z, _mm256_set1_pd(coef[k]));
+				return p;
+			}
+
+			inline __m256d absolute(__m256d v)
+			{
+				return _mm256_andnot_pd(_mm256_set1_pd(-0.0), v);
+			}
+
+			void sincos4(const double* x, double* s, double* c)
+			{
+				const __m256d v = _mm256_loadu_pd(x);
+				const __m256d q = _mm256_round_pd(_mm256_mul_pd(v, _mm256_set1_pd(TWO_O_PI)), _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+				__m256d r = _mm256_fnmadd_pd(q, _mm256_set1_pd(PIO2_1), v);
+				r = _mm256_fnmadd_pd(q, _mm256_set1_pd(PIO2_2), r);
+				r = _mm256_fnmadd_pd(q, _mm256_set1_pd(PIO2_3), r);
+				const __m256d z = _mm256_mul_pd(r, r);
+
+				const __m256d sr = _mm256_fmadd_pd(_mm256_mul_pd(r, z), polynomial(z, SIN_COEF, 6), r);
+				const __m256d cr = _mm256_fmadd_pd(_mm256_mul_pd(z, z), polynomial(z, COS_COEF, 6),
+					_mm256_fnmadd_pd(_mm256_set1_pd(0.5), z, _mm256_set1_pd(1.0)));
+
+				// the quadrant as an integer in the low mantissa bits, exact for |q| < 2^51
+				const __m256i qi = _mm256_castpd_si256(_mm256_add_pd(q, _mm256_set1_pd(6755399441055744.0)));
+				const __m256d swap = _mm256_castsi256_pd(_mm256_cmpeq_epi64(_mm256_and_si256(qi, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(1)));
+				const __m256d sinSign = _mm256_castsi256_pd(_mm256_slli_epi64(_mm256_and_si256(qi, _mm256_set1_epi64x(2)), 62));
+				const __m256d cosSign = _mm256_castsi256_pd(_mm256_slli_epi64(
+					_mm256_and_si256(_mm256_add_epi64(qi, _mm256_set1_epi64x(1)), _mm256_set1_epi64x(2)), 62));
+
+				// arguments are saved before the stores since the outputs may alias them
+				const int large = _mm256_movemask_pd(_mm256_cmp_pd(absolute(v), _mm256_set1_pd(SINCOS_MAX_ARG), _CMP_GT_OQ));
+				double saved[4];
+				if (large) _mm256_storeu_pd(saved, v);
+
+				_mm256_storeu_pd(s, _mm256_xor_pd(_mm256_blendv_pd(sr, cr, swap), sinSign));
+				_mm256_storeu_pd(c, _mm256_xor_pd(_mm256_blendv_pd(cr, sr, swap), cosSign));
+
+				for (int k = 0; large && k < 4; ++k) {
+					if (large & (1 << k)) {
+						s[k] = std::sin(saved[k]);
+						c[k] = std::cos(saved[k]);
+					}
+				}
+			}
+
+			void atan24(const double* y, const double* x, double* out)
+			{
+				const __m256d vy = _mm256_loadu_pd(y);
+				const __m256d vx = _mm256_loadu_pd(x);
+				const __m256d ax = absolute(vx), ay = absolute(vy);
+				const __m256d hi = _mm256_max_pd(ax, ay);
+				const __m256d lo = _mm256_min_pd(ax, ay);
+				const __m256d zero = _mm256_setzero_pd();
+				const __m256d one = _mm256_set1_pd(1.0);
+				const __m256d a = _mm256_blendv_pd(zero, _mm256_div_pd(lo, hi), _mm256_cmp_pd(hi, zero, _CMP_GT_OQ));
+
+				const __m256d big = _mm256_cmp_pd(a, _mm256_set1_pd(0.66), _CMP_GT_OQ);
+				const __m256d t = _mm256_blendv_pd(a, _mm256_div_pd(_mm256_sub_pd(a, one), _mm256_add_pd(a, one)), big);
+				const __m256d z = _mm256_mul_pd(t, t);
+
+				__m256d qq = _mm256_add_pd(z, _mm256_set1_pd(ATAN_Q[0]));
+				for (int k = 1; k < 5; ++k) qq = _mm256_fmadd_pd(qq, z, _mm256_set1_pd(ATAN_Q[k]));
+				__m256d r = _mm256_fmadd_pd(_mm256_mul_pd(t, z), _mm256_div_pd(polynomial(z, ATAN_P, 5), qq), t);
+				r = _mm256_blendv_pd(r, _mm256_add_pd(_mm256_set1_pd(PIO4), _mm256_add_pd(r, _mm256_set1_pd(0.5 * PIO2_LO))), big);
+
+				r = _mm256_blendv_pd(r, _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(PIO2_HI), r), _mm256_set1_pd(PIO2_LO)),
+					_mm256_cmp_pd(ay, ax, _CMP_GT_OQ));
+				const __m256d signBit = _mm256_set1_pd(-0.0);
+				r = _mm256_blendv_pd(r, _mm256_add_pd(_mm256_sub_pd(_mm256_set1_pd(PI_HI), r), _mm256_set1_pd(PI_LO)), vx);
+				_mm256_storeu_pd(out, _mm256_xor_pd(r, _mm256_and_pd(vy, signBit)));
+			}
+#endif
+		}
+
+		void sincos(const double* x, size_t n, double* s, double* c)
+		{
+			size_t i = 0;
+#ifdef FR_VECMATH_AVX2
+			for (; i + 4 <= n; i += 4) sincos4(x + i, s + i, c + i);
+#endif
+			for (; i < n; ++i) {
+				double sv, cv;
+				sincosScalar(x[i], sv, cv);
+				s[i] = sv;
+				c[i] = cv;
+			}
+		}
+
+		void atan2(const double* y, const double* x, size_t n, double* out)
+		{
+			size_t i = 0;
+#ifdef FR_VECMATH_AVX2
+			for (; i + 4 <= n; i += 4) atan24(y + i, x + i, out + i);
+#endif
+			for (; i < n; ++i) out[i] = atan2Scalar(y[i], x[i]);
+		}
+
+		void hypot(const double* x, const double* y, size_t n, double* out)
+		{
+			size_t i = 0;
+#ifdef FR_VECMATH_AVX2
+			for (; i + 4 <= n; i += 4) {
+				const __m256d vx = _mm256_loadu_pd(x + i);
+				const __m256d vy = _mm256_loadu_pd(y + i);
+				_mm256_storeu_pd(out + i, _mm256_sqrt_pd(_mm256_fmadd_pd(vx, vx, _mm256_mul_pd(vy, vy))));
+			}
+#endif
+			for (; i < n; ++i) out[i] = std::sqrt(x[i] * x[i] + y[i] * y[i]);
+		}
+	}
+}
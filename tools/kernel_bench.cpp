@@ -0,0 +1,374 @@
+// Copyright 2023 watson.wang
+// Accuracy versus speed of the math kernels.
+//
+//   kernel_bench [samples = 4096] [seed = 1] > bench.csv
+//
+// Every kernel variant is run over a set of input domains and compared with a long double
+// reference: Gauss-Legendre quadrature for the Fresnel integrals and the spiral end points, the
+// closed form boundary value solution for the polynomials. One csv row per variant, domain and
+// batch size:
+//
+//   kernel,variant,domain,batch,ns_per_call,mcalls_per_s,max_error,rms_error
+//
+// Batch rows time the batch entry points on consecutive slices of batch samples; scalar
+// variants report batch 1. Errors are absolute (metres for the spiral end points), any NaN output
+// reports max_error and rms_error nan.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <random>
+#include <string>
+#include <vector>
+#include "lane/euler_spiral.hpp"
+#include "lane/fresnel_integral.hpp"
+#include "lane/spiral_evaluator.hpp"
+#include "polynomials.hpp"
+
+namespace {
+	typedef long double real;
+
+	const real PI_L = 3.141592653589793238462643383279502884L;
+	const int GAUSS_ORDER = 12;
+	// timing loops repeat until they ran at least this long
+	const double MIN_SECONDS = 0.02;
+
+	struct Gauss
+	{
+		real node[GAUSS_ORDER];
+		real weight[GAUSS_ORDER];
+	};
+
+	// Gauss-Legendre rule on [-1, 1], roots of P_n by Newton from the Chebyshev guess
+	Gauss makeGauss()
+	{
+		Gauss g{};
+		for (int i = 0; i < GAUSS_ORDER; ++i) {
+			real x = cosl(PI_L * (i + 0.75L) / (GAUSS_ORDER + 0.5L));
+			real dp = 0.0L;
+			for (int it = 0; it < 100; ++it) {
+				real p0 = 1.0L, p1 = x;
+				for (int k = 2; k <= GAUSS_ORDER; ++k) {
+					real p2 = ((2 * k - 1) * x * p1 - (k - 1) * p0) / k;
+					p0 = p1;
+					p1 = p2;
+				}
+				dp = GAUSS_ORDER * (x * p1 - p0) / (x * x - 1.0L);
+				real dx = p1 / dp;
+				x -= dx;
+				if (fabsl(dx) < 1.0e-19L) break;
+			}
+			g.node[i] = x;
+			g.weight[i] = 2.0L / ((1.0L - x * x) * dp * dp);
+		}
+		return g;
+	}
+
+	const Gauss GAUSS = makeGauss();
+
+	// int_0^length of (cos, sin)(theta0 + k0 s + dk s^2 / 2), panels turn by at most 0.25 rad
+	void referenceIntegral(real length, real theta0, real k0, real dk, real& cx, real& sy)
+	{
+		real turn = fabsl(k0) * length + 0.5L * fabsl(dk) * length * length;
+		size_t panels = 1 + static_cast<size_t>(turn / 0.25L);
+		real h = length / panels;
+		cx = 0.0L;
+		sy = 0.0L;
+		for (size_t p = 0; p < panels; ++p) {
+			real mid = (p + 0.5L) * h;
+			for (int i = 0; i < GAUSS_ORDER; ++i) {
+				real s = mid + 0.5L * h * GAUSS.node[i];
+				real t = theta0 + k0 * s + 0.5L * dk * s * s;
+				cx += 0.5L * h * GAUSS.weight[i] * cosl(t);
+				sy += 0.5L * h * GAUSS.weight[i] * sinl(t);
+			}
+		}
+	}
+
+	// C(x) and S(x) of fresnel_cos_integral / fresnel_sin_integral
+	void referenceFresnel(double x, real& c, real& s)
+	{
+		referenceIntegral(fabsl(x), 0.0L, 0.0L, PI_L, c, s);
+		if (x < 0.0) {
+			c = -c;
+			s = -s;
+		}
+	}
+
+	struct Errors
+	{
+		double max{};
+		double rms{};
+	};
+
+	// running max and rms of absolute errors, a NaN error sticks in both
+	struct ErrorSum
+	{
+		double max{};
+		real sum{};
+		size_t count{};
+
+		void add(double d)
+		{
+			if (std::isnan(d) || d > max) max = d;
+			sum += static_cast<real>(d) * d;
+			++count;
+		}
+
+		Errors result() const { return { max, count == 0 ? 0.0 : static_cast<double>(sqrtl(sum / count)) }; }
+	};
+
+	Errors errors(const std::vector<double>& value, const std::vector<real>& reference)
+	{
+		ErrorSum e;
+		for (size_t i = 0; i < value.size(); ++i) e.add(static_cast<double>(fabsl(value[i] - reference[i])));
+		return e.result();
+	}
+
+	// the larger of two errors, NaN wins
+	double worse(double a, double b) { return std::isnan(a) || a > b ? a : b; }
+
+	// pair error of the C and S outputs
+	Errors pairErrors(const std::vector<double>& c, const std::vector<real>& rc, const std::vector<double>& s, const std::vector<real>& rs)
+	{
+		Errors ec = errors(c, rc), es_ = errors(s, rs);
+		return { worse(ec.max, es_.max), worse(ec.rms, es_.rms) };
+	}
+
+	// ns per sample of run(begin, end) over all samples, repeated until MIN_SECONDS
+	double timePerCall(size_t n, size_t batch, const std::function<void(size_t, size_t)>& run)
+	{
+		size_t calls = 0;
+		auto start = std::chrono::steady_clock::now();
+		double elapsed = 0.0;
+		do {
+			for (size_t i = 0; i < n; i += batch) run(i, std::min(n, i + batch));
+			calls += n;
+			elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		} while (elapsed < MIN_SECONDS);
+		return elapsed * 1.0e9 / calls;
+	}
+
+	void report(const char* kernel, const std::string& variant, const char* domain, size_t batch, double ns, const Errors& e)
+	{
+		std::printf("%s,%s,%s,%zu,%.2f,%.2f,%.3e,%.3e\n", kernel, variant.c_str(), domain, batch, ns, 1.0e3 / ns, e.max, e.rms);
+	}
+
+	struct Domain
+	{
+		const char* name;
+		double lo, hi;
+	};
+
+	const struct { const char* name; es::FresnelPrecision precision; } TIERS[] = {
+		{ "reference", es::FresnelPrecision::REFERENCE },
+		{ "double", es::FresnelPrecision::DOUBLE },
+		{ "fast", es::FresnelPrecision::FAST },
+		{ "table", es::FresnelPrecision::TABLE },
+	};
+
+	volatile double sink = 0.0;
+
+	void benchFresnel(size_t n, std::mt19937& rng)
+	{
+		const Domain domains[] = {
+			{ "power_series", -0.39, 0.39 },
+			{ "chebyshev", 0.4, 5.5 },
+			{ "asymptotic", 5.6, 12.0 },
+			{ "planner", -6.0, 6.0 },
+		};
+
+		for (const Domain& dom : domains) {
+			std::uniform_real_distribution<double> dist(dom.lo, dom.hi);
+			std::vector<double> x(n);
+			std::vector<real> rc(n), rs(n);
+			for (size_t i = 0; i < n; ++i) {
+				x[i] = dist(rng);
+				referenceFresnel(x[i], rc[i], rs[i]);
+			}
+
+			std::vector<double> c(n), s(n);
+			for (size_t i = 0; i < n; ++i) c[i] = es::fresnel_cos_integral(x[i]);
+			double ns = timePerCall(n, 1, [&](size_t b, size_t) { sink = sink + es::fresnel_cos_integral(x[b]); });
+			report("fresnel_cos_integral", "legacy", dom.name, 1, ns, errors(c, rc));
+
+			for (size_t i = 0; i < n; ++i) s[i] = es::fresnel_sin_integral(x[i]);
+			ns = timePerCall(n, 1, [&](size_t b, size_t) { sink = sink + es::fresnel_sin_integral(x[b]); });
+			report("fresnel_sin_integral", "legacy", dom.name, 1, ns, errors(s, rs));
+
+			// the pair error is the larger of the C and S errors
+			for (const auto& tier : TIERS) {
+				for (size_t i = 0; i < n; ++i) {
+					es::FresnelPair p = es::fresnel_cs(x[i], tier.precision);
+					c[i] = p.c;
+					s[i] = p.s;
+				}
+				ns = timePerCall(n, 1, [&](size_t b, size_t) { sink = sink + es::fresnel_cs(x[b], tier.precision).c; });
+				report("fresnel_cs", tier.name, dom.name, 1, ns, pairErrors(c, rc, s, rs));
+
+				// the timed loop leaves the batch output of every sample in c and s
+				for (size_t batch : { 16, 256, 4096 }) {
+					if (batch > n) break;
+					std::fill(c.begin(), c.end(), std::nan(""));
+					std::fill(s.begin(), s.end(), std::nan(""));
+					ns = timePerCall(n, batch, [&](size_t b, size_t end) {
+						es::fresnel_cs(x.data() + b, end - b, c.data() + b, s.data() + b, tier.precision);
+						});
+					report("fresnel_cs_batch", tier.name, dom.name, batch, ns, pairErrors(c, rc, s, rs));
+				}
+			}
+		}
+	}
+
+	void benchEndPoint(size_t n, std::mt19937& rng)
+	{
+		// near straight spirals are served by the series, general ones by the Fresnel pair
+		const struct { const char* name; double maxCurv, maxDCurv, maxLength; } domains[] = {
+			{ "near_straight", 0.02, 1.0e-5, 100.0 },
+			{ "general", 0.2, 0.02, 60.0 },
+		};
+
+		for (const auto& dom : domains) {
+			std::uniform_real_distribution<double> curv(-dom.maxCurv, dom.maxCurv), dcurv(-dom.maxDCurv, dom.maxDCurv),
+				length(1.0, dom.maxLength), angle(-3.0, 3.0);
+			std::vector<es::SpiralParameter> param(n);
+			std::vector<double> theta(n);
+			std::vector<real> rx(n), ry(n);
+			for (size_t i = 0; i < n; ++i) {
+				param[i].length = length(rng);
+				param[i].initCurv = curv(rng);
+				param[i].dCurv = dcurv(rng);
+				theta[i] = angle(rng);
+				referenceIntegral(param[i].length, theta[i], param[i].initCurv, param[i].dCurv, rx[i], ry[i]);
+			}
+
+			std::vector<double> dist(n);
+			std::vector<real> zero(n, 0.0L);
+			for (const auto& tier : TIERS) {
+				for (size_t i = 0; i < n; ++i) {
+					es::SpiralPoint p = es::getEndPoint(param[i].length, param[i].dCurv, param[i].initCurv, 0.0, 0.0, theta[i], tier.precision);
+					dist[i] = static_cast<double>(hypotl(p.x - rx[i], p.y - ry[i]));
+				}
+				double ns = timePerCall(n, 1, [&](size_t b, size_t) {
+					const es::SpiralParameter& p = param[b];
+					sink = sink + es::getEndPoint(p.length, p.dCurv, p.initCurv, 0.0, 0.0, theta[b], tier.precision).x;
+					});
+				report("getEndPoint", tier.name, dom.name, 1, ns, errors(dist, zero));
+			}
+
+			// every spiral prepared and sampled densely, the reference line use case. The batch is
+			// evaluated sample by sample, so the error of every spiral is taken on a CHECKS sample grid
+			// and holds for all batch sizes. The timed loop walks as many spirals as cover n * CHECKS
+			// samples and rebuilds the sample grid of each, one multiply per sample
+			const size_t CHECKS = 16;
+			std::vector<double> s(CHECKS), x, y, t;
+			std::vector<real> ex(n * CHECKS), ey(n * CHECKS);
+			for (size_t i = 0; i < n; ++i) {
+				for (size_t j = 0; j < CHECKS; ++j) {
+					s[j] = param[i].length * j / CHECKS;
+					referenceIntegral(s[j], theta[i], param[i].initCurv, param[i].dCurv, ex[i * CHECKS + j], ey[i * CHECKS + j]);
+				}
+			}
+
+			for (const auto& tier : TIERS) {
+				std::vector<es::PreparedSpiral> spirals;
+				spirals.reserve(n);
+				ErrorSum e;
+				for (size_t i = 0; i < n; ++i) {
+					spirals.emplace_back(param[i], 0.0, 0.0, theta[i], tier.precision);
+					for (size_t j = 0; j < CHECKS; ++j) s[j] = param[i].length * j / CHECKS;
+					spirals[i].evaluate(s, x, y, t);
+					for (size_t j = 0; j < CHECKS; ++j) {
+						e.add(static_cast<double>(hypotl(x[j] - ex[i * CHECKS + j], y[j] - ey[i * CHECKS + j])));
+					}
+				}
+
+				for (size_t batch : { 16, 256, 4096 }) {
+					if (batch > n) break;
+					const size_t walked = std::min(n, std::max<size_t>(1, n * CHECKS / batch));
+					std::vector<double> grid(batch);
+					double ns = timePerCall(walked * batch, batch, [&](size_t b, size_t) {
+						const es::PreparedSpiral& spiral = spirals[b / batch];
+						for (size_t j = 0; j < batch; ++j) grid[j] = spiral.parameter().length * j / batch;
+						spiral.evaluate(grid, x, y, t);
+						});
+					report("PreparedSpiral::evaluate", tier.name, dom.name, batch, ns, e.result());
+				}
+			}
+		}
+	}
+
+	void benchPolynomials(size_t n, std::mt19937& rng)
+	{
+		std::uniform_real_distribution<double> pos(-5.0, 5.0), vel(-3.0, 3.0), acc(-2.0, 2.0), dur(1.0, 8.0), frac(0.0, 1.0);
+
+		std::vector<fr::QuinticPolynomial> quintic;
+		std::vector<fr::QuarticPolynomial> quartic;
+		// long double coefficients t^0 .. t^5 of the same boundary value problems
+		std::vector<std::vector<real>> quinticRef, quarticRef;
+		std::vector<double> t(n);
+		for (size_t i = 0; i < n; ++i) {
+			real x0 = pos(rng), v0 = vel(rng), a0 = acc(rng), xT = pos(rng), vT = vel(rng), aT = acc(rng), T = dur(rng);
+			quintic.emplace_back(x0, v0, a0, xT, vT, aT, T);
+			quartic.emplace_back(x0, v0, a0, vT, aT, T);
+			t[i] = frac(rng) * T;
+
+			real d = xT - x0 - v0 * T - 0.5L * a0 * T * T, dv = vT - v0 - a0 * T, da = aT - a0;
+			quinticRef.push_back({ x0, v0, 0.5L * a0, (10.0L * d - 4.0L * dv * T + 0.5L * da * T * T) / (T * T * T),
+				(-15.0L * d + 7.0L * dv * T - da * T * T) / (T * T * T * T), (6.0L * d - 3.0L * dv * T + 0.5L * da * T * T) / (T * T * T * T * T) });
+			quarticRef.push_back({ x0, v0, 0.5L * a0, (3.0L * dv - da * T) / (3.0L * T * T), (da * T - 2.0L * dv) / (4.0L * T * T * T), 0.0L });
+		}
+
+		// derivative `order` of the reference polynomial at t
+		auto evaluate = [](const std::vector<real>& c, real t, int order) {
+			real sum = 0.0L;
+			for (int k = 5; k >= order; --k) {
+				real f = 1.0L;
+				for (int j = 0; j < order; ++j) f *= k - j;
+				sum = sum * t + f * c[k];
+			}
+			return sum;
+		};
+
+		const char* names[] = { "position", "velocity", "acceleration", "jerk" };
+		std::vector<double> value(n);
+		std::vector<real> ref(n);
+		for (int order = 0; order < 4; ++order) {
+			for (int kind = 0; kind < 2; ++kind) {
+				auto at = [&](size_t i) -> const fr::Polynomial& {
+					return kind == 0 ? static_cast<const fr::Polynomial&>(quintic[i]) : quartic[i];
+				};
+				auto call = [&](size_t i) {
+					const fr::Polynomial& p = at(i);
+					switch (order) {
+					case 0: return p.position(t[i]);
+					case 1: return p.velocity(t[i]);
+					case 2: return p.acceleration(t[i]);
+					default: return p.jerk(t[i]);
+					}
+				};
+				for (size_t i = 0; i < n; ++i) {
+					value[i] = call(i);
+					ref[i] = evaluate(kind == 0 ? quinticRef[i] : quarticRef[i], t[i], order);
+				}
+				double ns = timePerCall(n, 1, [&](size_t b, size_t) { sink = sink + call(b); });
+				report(kind == 0 ? "QuinticPolynomial" : "QuarticPolynomial", names[order], "boundary_value", 1, ns, errors(value, ref));
+			}
+		}
+	}
+}
+
+int main(int argc, char** argv)
+{
+	const size_t samples = argc > 1 ? std::max(16, std::atoi(argv[1])) : 4096;
+	std::mt19937 rng(argc > 2 ? std::atoi(argv[2]) : 1);
+
+	std::printf("kernel,variant,domain,batch,ns_per_call,mcalls_per_s,max_error,rms_error\n");
+	benchFresnel(samples, rng);
+	benchEndPoint(samples, rng);
+	benchPolynomials(samples, rng);
+	return 0;
+}
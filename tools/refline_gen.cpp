@@ -0,0 +1,65 @@
+// Copyright 2023 watson.wang
+// Offline generator of memory mapped reference line files.
+//
+//   refline_gen <waypoints.csv> <out.bin> [tolerance = 1e-6] [stride = 1]
+//
+// The csv holds one waypoint "x,y,heading" per line, as main.cpp writes spinline.csv. Every
+// stride-th waypoint (and the last one) is kept, each pair is fitted by fitRoute and the table
+// resolution is the coarsest one within tolerance metres.
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "lane/reference_file.hpp"
+
+int main(int argc, char** argv)
+{
+	if (argc < 3) {
+		std::cerr << "usage: " << argv[0] << " <waypoints.csv> <out.bin> [tolerance] [stride]" << std::endl;
+		return 1;
+	}
+	const double tolerance = argc > 3 ? std::atof(argv[3]) : 1.0e-6;
+	const size_t stride = argc > 4 ? std::max(1, std::atoi(argv[4])) : 1;
+
+	std::ifstream in(argv[1]);
+	if (!in) {
+		std::cerr << "cannot read " << argv[1] << std::endl;
+		return 1;
+	}
+
+	std::vector<es::SpiralPoint> all;
+	std::string line;
+	while (std::getline(in, line)) {
+		std::stringstream ss(line);
+		es::SpiralPoint p;
+		char c1 = 0, c2 = 0;
+		if (ss >> p.x >> c1 >> p.y >> c2 >> p.t && c1 == ',' && c2 == ',') all.push_back(p);
+	}
+	if (all.size() < 2) {
+		std::cerr << "need at least two waypoints" << std::endl;
+		return 1;
+	}
+
+	std::vector<es::SpiralPoint> waypoints;
+	for (size_t i = 0; i < all.size(); i += stride) waypoints.push_back(all[i]);
+	if ((all.size() - 1) % stride != 0) waypoints.push_back(all.back());
+
+	es::RouteFitReport fit = es::fitRoute(waypoints);
+	for (size_t i : fit.flagged) {
+		std::cerr << "segment " << i << " residual " << fit.segments[i].residual << std::endl;
+	}
+
+	es::SpiralRoute route(waypoints, fit);
+	const double ds = es::ReferenceTable::resolutionFor(route.window(0.0, 0.0, route.length()), tolerance);
+	if (!es::writeReferenceFile(argv[2], route, ds)) {
+		std::cerr << "cannot write " << argv[2] << std::endl;
+		return 1;
+	}
+
+	std::cout << route.size() << " segments, " << route.length() << " m, table ds " << ds << " m, "
+		<< fit.flagged.size() << " flagged" << std::endl;
+	return 0;
+}